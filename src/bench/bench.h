@@ -0,0 +1,54 @@
+// ======================================================================
+// File: bench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/args.h"
+#include "core/utils.h"
+
+#include "engine/camera.h"
+#include "engine/framebuffer.h"
+#include "engine/renderer.h"
+
+#include <chrono>
+#include <cstring>
+
+// Shared helpers for the "--bench <name>" modes. Benchmarks render with a fixed
+// seed so every variant traces exactly the same rays and images can be compared.
+namespace bench
+{
+    inline RenderSettings get_settings(const Args& _args, u32 _width, u32 _height, u32 _nb_samples)
+    {
+        RenderSettings settings;
+        settings.width      = _args.get_u32("--width", _width);
+        settings.height     = _args.get_u32("--height", _height);
+        settings.nb_samples = _args.get_u32("--samples", _nb_samples);
+        settings.tile_size  = _args.get_u32("--tile", settings.tile_size);
+        settings.seed       = _args.get_u64("--seed", settings.seed);
+        settings.progress_interval_ms = 0u;
+        return settings;
+    }
+
+    inline Camera get_camera(const RenderSettings& _settings)
+    {
+        return Camera(fv3(13.f, 2.f, -8.f), fv3(0.f, 0.f, 0.f), _settings.width, _settings.height, 25.f, 0.f);
+    }
+
+    inline b32 is_same_image(const Framebuffer& _a, const Framebuffer& _b)
+    {
+        return _a.get_width() == _b.get_width() && _a.get_height() == _b.get_height() &&
+               std::memcmp(_a.get_data(), _b.get_data(), _a.get_nb_pixels() * sizeof(rgb)) == 0;
+    }
+
+    template<typename Fn>
+    inline f64 time_seconds(Fn&& _fn)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        _fn();
+        return std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
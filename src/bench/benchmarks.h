@@ -0,0 +1,62 @@
+// ======================================================================
+// File: benchmarks.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+#include "bench/bvhbench.h"
+#include "bench/bvhbuildbench.h"
+#include "bench/bvhcachebench.h"
+#include "bench/instancebench.h"
+#include "bench/numabench.h"
+#include "bench/occlusionbench.h"
+#include "bench/orderbench.h"
+#include "bench/outlierbench.h"
+#include "bench/refitbench.h"
+#include "bench/scenebench.h"
+
+#include <string>
+
+namespace bench
+{
+    struct Entry
+    {
+        const utf8* name;
+        s32 (*run)(const Args& _args);
+        const utf8* description;
+    };
+
+    inline constexpr Entry k_entries[] =
+    {
+        { "bvh", &run_bvh, "median, binned SAH and LBVH builders on the random scene, build time, SAH cost and rays/s" },
+        { "bvhbuild", &run_bvh_build, "parallel SAH and LBVH builds for growing thread counts, per-level times, checks the tree is identical" },
+        { "bvhcache", &run_bvh_cache, "flat BVH startup without cache, on a miss, mapped cold and warm from the cache, checks the images match" },
+        { "instancing", &run_instancing, "instanced scene on growing grids, instance vs placed geometry memory, top-level build time and rays/s" },
+        { "numa", &run_numa, "pinned workers, first-touch framebuffer and per-node scene replicas vs unpinned" },
+        { "occlusion", &run_occlusion, "shadow rays per BVH layout as closest hits, occluded() and batched occluded(), rays/s and node visits" },
+        { "outliers", &run_outliers, "ground sphere inside the BVH vs in the outlier list, and a ground plane, SAH cost, node visits and rays/s" },
+        { "order", &run_order, "scanline/Morton/Hilbert tile orders and scanline/Morton pixel orders, time and cache misses" },
+        { "refit", &run_refit, "animated random scene, refit with threshold-triggered subtree rebuilds vs refit only vs full rebuilds" },
+        { "scene", &run_scene, "parallel procedural scene construction for growing thread counts, checks the result is identical" },
+    };
+
+    // Entry point for "--bench <name>", returns the process exit code
+    inline s32 run(const Args& _args)
+    {
+        const std::string name = _args.get_str("--bench", "");
+        for (const Entry& entry : k_entries)
+        {
+            if (name == entry.name)
+                return entry.run(_args);
+        }
+
+        util::output_to_console("Unknown benchmark '%s', available:", name.c_str());
+        for (const Entry& entry : k_entries)
+            util::output_to_console("  %-12s %s", entry.name, entry.description);
+        return 1;
+    }
+}
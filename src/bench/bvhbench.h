@@ -0,0 +1,188 @@
+// ======================================================================
+// File: bvhbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "engine/bvh.h"
+#include "engine/bvhfactory.h"
+#include "engine/scenes.h"
+
+#include <string>
+
+namespace bench
+{
+    // Cross-checks the SIMD child test of a _width-wide node against the scalar AABB::is_hit
+    // on random boxes and rays, including flat boxes, axis-parallel rays and origins on a
+    // slab plane. Returns the number of lanes that disagree.
+    template <u32 _width>
+    inline u32 check_wide_slab_test(u64 _seed, u32 _nb_tests)
+    {
+        Rng rng(_seed);
+        auto rnd = [&rng](f32 _extent) { return _extent * (2.f * util::frand_01(rng) - 1.f); };
+        auto rnd_fv3 = [&rnd](f32 _extent) { const f32 x = rnd(_extent); const f32 y = rnd(_extent); const f32 z = rnd(_extent); return fv3(x, y, z); };
+
+        u32 nb_mismatches = 0u;
+        for (u32 test = 0u; test < _nb_tests; ++test)
+        {
+            typename WideBVH<_width>::Node node;
+            AABB boxes[_width];
+            for (u32 lane = 0u; lane < _width; ++lane)
+            {
+                const fv3 a = rnd_fv3(4.f);
+                fv3 b = rnd_fv3(4.f);
+                if (lane == 1u)
+                    b.y = a.y; // flat box
+                boxes[lane] = AABB(fv3(math::min(a.x, b.x), math::min(a.y, b.y), math::min(a.z, b.z)),
+                                   fv3(math::max(a.x, b.x), math::max(a.y, b.y), math::max(a.z, b.z)));
+                WideBVH<_width>::set_lane(&node, lane, &boxes[lane]);
+            }
+
+            fv3 origin = rnd_fv3(8.f);
+            fv3 direction = rnd_fv3(1.f);
+            if (test % 4u == 1u)
+                direction.x = 0.f;
+            if (test % 4u == 2u)
+                origin.z = boxes[0].min.z;
+            const Ray ray(origin, direction);
+
+            const f32 tmin = 0.001f;
+            const f32 tmax = (test % 2u == 0u) ? std::numeric_limits<f32>::max() : 4.f;
+            f32 tnear[_width];
+            const u32 mask = WideBVH<_width>::intersect(node, ray, tmin, tmax, tnear);
+            for (u32 lane = 0u; lane < _width; ++lane)
+                nb_mismatches += (((mask >> lane) & 1u) != u32(boxes[lane].is_hit(ray, tmin, tmax))) ? 1u : 0u;
+        }
+        return nb_mismatches;
+    }
+
+    // Builds the random scene's BVH with the median builder, the SAH builder at a few leaf
+    // sizes and the LBVH, pointer-based, flattened, 4/8-wide and motion-interpolated, ordered or not, then renders
+    // the same frame with each: build time, SAH cost, node visits per ray, rays/s.
+    inline s32 run_bvh(const Args& _args)
+    {
+        s32 exit_code = 0;
+        const u32 nb_slab_tests = _args.get_u32("--slab-tests", 100000u);
+        const u32 nb_mismatches4 = check_wide_slab_test<4u>(_args.get_u64("--seed", RenderSettings {}.seed), nb_slab_tests);
+        const u32 nb_mismatches8 = check_wide_slab_test<8u>(_args.get_u64("--seed", RenderSettings {}.seed), nb_slab_tests);
+        util::output_to_console("Wide slab test vs AABB::is_hit: %u rays, %u BVH4 and %u BVH8 lane mismatches (%s)", nb_slab_tests,
+                                nb_mismatches4, nb_mismatches8,
+#if defined(__AVX__)
+                                "AVX"
+#else
+                                "SSE"
+#endif
+                                );
+        exit_code = (nb_mismatches4 + nb_mismatches8 == 0u) ? exit_code : 1;
+
+        const RenderSettings settings = get_settings(_args, 400u, 240u, 8u);
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const Camera camera = get_camera(settings);
+
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        HitableList* primitives = generate_rand_world(&pool, settings.seed, _args.get_u32("--grid", 10u));
+        util::output_to_console("%u primitives, %ux%u at %u spp", primitives->get_size(), settings.width, settings.height, settings.nb_samples);
+
+        struct Variant
+        {
+            BVHBuilder builder;
+            BVHLayout layout;
+            u32 max_leaf_size;
+            BVHTraversal traversal = BVHTraversal::Ordered;
+            u32 max_time_splits = 0u;
+        };
+        constexpr Variant k_variants[] =
+        {
+            { BVHBuilder::Median, BVHLayout::Pointer, 1u, BVHTraversal::Unordered },
+            { BVHBuilder::Median, BVHLayout::Pointer, 1u },
+            { BVHBuilder::Median, BVHLayout::Flat, 1u },
+            { BVHBuilder::SAH, BVHLayout::Pointer, 1u, BVHTraversal::Unordered },
+            { BVHBuilder::SAH, BVHLayout::Pointer, 1u },
+            { BVHBuilder::SAH, BVHLayout::Flat, 1u, BVHTraversal::Unordered },
+            { BVHBuilder::SAH, BVHLayout::Flat, 1u },
+            { BVHBuilder::SAH, BVHLayout::Pointer, 4u },
+            { BVHBuilder::SAH, BVHLayout::Flat, 4u, BVHTraversal::Unordered },
+            { BVHBuilder::SAH, BVHLayout::Flat, 4u },
+            { BVHBuilder::SAH, BVHLayout::Flat, 8u },
+            { BVHBuilder::SAH, BVHLayout::Wide4, 1u },
+            { BVHBuilder::SAH, BVHLayout::Wide4, 4u },
+            { BVHBuilder::SAH, BVHLayout::Wide8, 1u },
+            { BVHBuilder::SAH, BVHLayout::Wide8, 4u },
+            { BVHBuilder::SAH, BVHLayout::Motion, 4u },
+            { BVHBuilder::SAH, BVHLayout::Motion, 4u, BVHTraversal::Ordered, 1u },
+            { BVHBuilder::SAH, BVHLayout::Motion, 4u, BVHTraversal::Ordered, 3u },
+            { BVHBuilder::LBVH, BVHLayout::Pointer, 1u, BVHTraversal::Unordered },
+            { BVHBuilder::LBVH, BVHLayout::Pointer, 1u },
+            { BVHBuilder::LBVH, BVHLayout::Flat, 1u },
+            { BVHBuilder::LBVH, BVHLayout::Wide8, 1u },
+        };
+
+        Framebuffer reference(settings.width, settings.height);
+        f64 baseline_seconds = 0.;
+
+        util::output_to_console("%-8s %-8s %5s %-9s %6s %10s %9s %11s %9s %9s %8s", "builder", "layout", "leaf", "traversal", "tsplit", "build ms", "SAH cost",
+                                "visits/ray", "seconds", "Mrays/s", "speedup");
+        for (const Variant& variant : k_variants)
+        {
+            BVHSettings bvh_settings;
+            bvh_settings.builder = variant.builder;
+            bvh_settings.layout = variant.layout;
+            bvh_settings.max_leaf_size = variant.max_leaf_size;
+            bvh_settings.traversal = variant.traversal;
+            bvh_settings.max_time_splits = variant.max_time_splits;
+
+            Hitable* bvh = nullptr;
+            const f64 build_seconds = time_seconds([&]()
+            {
+                bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings);
+            });
+
+            Renderer renderer(pool, settings);
+            Framebuffer framebuffer(settings.width, settings.height);
+            RenderStats best;
+            for (u32 run = 0u; run < nb_runs; ++run)
+            {
+                const RenderStats stats = renderer.render(camera, bvh, &framebuffer);
+                if (run == 0u || stats.seconds < best.seconds)
+                    best = stats;
+            }
+
+            // Counted on a separate render so the timed ones stay uninstrumented
+            BVHTraversalStats::reset();
+            BVHTraversalStats::set_enabled(true);
+            const RenderStats counted = renderer.render(camera, bvh, &framebuffer);
+            BVHTraversalStats::set_enabled(false);
+            const f64 visits_per_ray = f64(BVHTraversalStats::get_nb_node_visits()) / f64(math::max(counted.nb_rays, u64(1u)));
+
+            const b32 is_baseline = (&variant == &k_variants[0]);
+            if (is_baseline)
+                baseline_seconds = best.seconds;
+            util::output_to_console("%-8s %-8s %5u %-9s %6u %10.3f %9.4f %11.2f %9.3f %9.2f %7.2fx", get_name(variant.builder), get_name(variant.layout),
+                                    variant.max_leaf_size, get_name(variant.traversal), variant.max_time_splits, build_seconds * 1e3,
+                                    get_bvh_sah_cost(bvh, bvh_settings.traversal_cost), visits_per_ray, best.seconds,
+                                    f64(best.nb_rays) / best.seconds / 1e6, baseline_seconds / best.seconds);
+
+            // The tree shape and layout must never change which surface a ray hits
+            if (is_baseline)
+                reference = std::move(framebuffer);
+            else if (!is_same_image(reference, framebuffer))
+            {
+                util::output_to_console("ERROR: image differs for %s/%s, leaf %u, %s", get_name(variant.builder), get_name(variant.layout),
+                                        variant.max_leaf_size, get_name(variant.traversal));
+                exit_code = 1;
+            }
+
+            util::safe_del(bvh);
+        }
+
+        util::safe_del(primitives);
+        return exit_code;
+    }
+}
@@ -0,0 +1,91 @@
+// ======================================================================
+// File: bvhbuildbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/threadpool.h"
+#include "engine/bvh.h"
+#include "engine/scenes.h"
+
+#include <cstring>
+#include <vector>
+
+namespace bench
+{
+    // Builds the random scene's SAH BVH and LBVH on pools of growing size: total time, speedup
+    // and the SAH per-level times of the largest pool. The SAH cost is compared bit for bit,
+    // the parallel builds have to produce the same tree as the serial ones.
+    inline s32 run_bvh_build(const Args& _args)
+    {
+        const u64 seed = _args.get_u64("--seed", RenderSettings {}.seed);
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const u32 max_threads = _args.get_u32("--threads", ThreadPool::get_default_nb_threads());
+
+        HitableList* primitives = nullptr;
+        {
+            ThreadPool pool(max_threads);
+            primitives = generate_rand_world(&pool, seed, _args.get_u32("--grid", 250u));
+        }
+        util::output_to_console("%u primitives, best of %u builds", primitives->get_size(), nb_runs);
+
+        std::vector<u32> thread_counts;
+        for (u32 nb_threads = 1u; nb_threads < max_threads; nb_threads *= 2u)
+            thread_counts.push_back(nb_threads);
+        thread_counts.push_back(max_threads);
+
+        s32 exit_code = 0;
+        BVHBuildStats best_stats;
+        for (const BVHBuilder builder : { BVHBuilder::SAH, BVHBuilder::LBVH })
+        {
+            u32 reference_cost = 0u;
+            f64 serial_seconds = 0.;
+            for (const u32 nb_threads : thread_counts)
+            {
+                ThreadPool pool(nb_threads);
+                BVHBuildStats stats;
+                BVHSettings bvh_settings;
+                bvh_settings.builder = builder;
+                bvh_settings.pool = &pool;
+                bvh_settings.build_stats = &stats;
+
+                f64 best_seconds = 0.;
+                u32 cost_bits = 0u;
+                for (u32 run = 0u; run < nb_runs; ++run)
+                {
+                    BVH* bvh = nullptr;
+                    const f64 seconds = time_seconds([&]() { bvh = new BVH(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings); });
+                    const f32 cost = bvh->get_sah_cost(bvh_settings.traversal_cost);
+                    std::memcpy(&cost_bits, &cost, sizeof(cost_bits));
+                    if (run == 0u || seconds < best_seconds)
+                    {
+                        best_seconds = seconds;
+                        if (builder == BVHBuilder::SAH)
+                            best_stats = stats;
+                    }
+                    util::safe_del(bvh);
+                }
+
+                if (nb_threads == thread_counts.front())
+                {
+                    reference_cost = cost_bits;
+                    serial_seconds = best_seconds;
+                }
+                f32 cost;
+                std::memcpy(&cost, &cost_bits, sizeof(cost));
+                util::output_to_console("%-4s %2u threads: %.3fs (%.2fx) SAH cost %.4f%s", get_name(builder), nb_threads, best_seconds,
+                                        serial_seconds / best_seconds, cost, (cost_bits == reference_cost) ? "" : " MISMATCH");
+                exit_code = (cost_bits == reference_cost) ? exit_code : 1;
+            }
+        }
+
+        best_stats.print();
+        util::safe_del(primitives);
+        return exit_code;
+    }
+}
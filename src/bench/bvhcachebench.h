@@ -0,0 +1,98 @@
+// ======================================================================
+// File: bvhcachebench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/mappedfile.h"
+#include "core/threadpool.h"
+#include "engine/bvhcache.h"
+#include "engine/bvhfactory.h"
+#include "engine/scenes.h"
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace bench
+{
+    // Startup of a flat SAH BVH over the random scene: built without the cache, built and
+    // stored on a miss, mapped after dropping the file from the page cache (cold) and mapped
+    // again (warm). The first frame is part of startup, a mapped tree is paged in while it is
+    // traced. Every frame has to match the one traced over the built tree.
+    inline s32 run_bvh_cache(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 160u, 100u, 1u);
+        const Camera camera = get_camera(settings);
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        HitableList* primitives = generate_rand_world(&pool, settings.seed, _args.get_u32("--grid", 200u));
+
+        BVHCacheStats cache_stats;
+        BVHSettings bvh_settings;
+        bvh_settings.pool = &pool;
+        bvh_settings.layout = BVHLayout::Flat;
+        bvh_settings.cache_stats = &cache_stats;
+
+        // create_bvh() caches the tree over the primitives it keeps, without the ground sphere
+        std::vector<Hitable*> inliers;
+        std::vector<Hitable*> outliers;
+        OutlierBVH::split(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings.outlier_area_ratio, &inliers, &outliers);
+        const u64 key = bvhcache::compute_key(inliers.data(), u32(inliers.size()), 0.f, 1.f, bvh_settings);
+        const std::filesystem::path path = bvhcache::get_path(_args.get_str("--cache", "out/bvhcache"), key);
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        util::output_to_console("%u primitives, %ux%u at %u spp, cache file %s", primitives->get_size(), settings.width, settings.height,
+                                settings.nb_samples, path.string().c_str());
+
+        enum class Run { NoCache, Miss, Cold, Warm };
+        constexpr Run k_runs[] = { Run::NoCache, Run::Miss, Run::Cold, Run::Warm };
+        constexpr const utf8* k_run_names[] = { "no cache", "miss", "cold", "warm" };
+
+        util::output_to_console("%-9s %8s %10s %10s %10s %10s %8s", "run", "hit", "key ms", "BVH ms", "frame ms", "startup ms", "MB");
+        Renderer renderer(pool, settings);
+        std::unique_ptr<Framebuffer> reference;
+        s32 exit_code = 0;
+        for (const Run run : k_runs)
+        {
+            cache_stats = {};
+            bvh_settings.cache_dir = (run == Run::NoCache) ? std::string() : path.parent_path().string();
+            if (run == Run::Cold && !MappedFile::evict_from_page_cache(path))
+                util::output_to_console("Could not drop %s from the page cache, the cold run is warm", path.string().c_str());
+
+            Hitable* bvh = nullptr;
+            const f64 bvh_seconds = time_seconds([&]() { bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings); });
+            std::unique_ptr<Framebuffer> framebuffer = std::make_unique<Framebuffer>(settings.width, settings.height);
+            const RenderStats stats = renderer.render(camera, bvh, framebuffer.get());
+
+            const utf8* run_name = k_run_names[static_cast<u32>(run)];
+            util::output_to_console("%-9s %8s %10.3f %10.3f %10.3f %10.3f %8.1f", run_name, cache_stats.is_hit ? "yes" : "no",
+                                    cache_stats.key_seconds * 1e3, bvh_seconds * 1e3, stats.seconds * 1e3, (bvh_seconds + stats.seconds) * 1e3,
+                                    f64(cache_stats.file_size) / (1024. * 1024.));
+            util::safe_del(bvh);
+
+            if (!reference)
+            {
+                reference = std::move(framebuffer);
+            }
+            else if (!is_same_image(*reference, *framebuffer))
+            {
+                util::output_to_console("MISMATCH: the %s run's frame differs from the built tree's", run_name);
+                exit_code = 1;
+            }
+            if (run == Run::Miss && !cache_stats.is_stored)
+            {
+                util::output_to_console("Could not store the BVH in %s", path.string().c_str());
+                exit_code = 1;
+                break;
+            }
+        }
+
+        util::safe_del(primitives);
+        return exit_code;
+    }
+}
@@ -0,0 +1,79 @@
+// ======================================================================
+// File: instancebench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/threadpool.h"
+#include "engine/bvhfactory.h"
+#include "engine/instance.h"
+#include "engine/scenes.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bench
+{
+    // Instanced scene on growing grids: placements, unique and placed spheres, the memory the
+    // instances take next to the spheres they stand for, top-level build time and rays/s.
+    inline s32 run_instancing(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 200u, 120u, 2u);
+        const u32 max_grid_extent = _args.get_u32("--grid", 250u);
+        const Camera camera = get_camera(settings);
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+
+        std::vector<u32> grid_extents;
+        for (u32 grid_extent = 10u; grid_extent < max_grid_extent; grid_extent *= 4u)
+            grid_extents.push_back(grid_extent);
+        grid_extents.push_back(max_grid_extent);
+
+        util::output_to_console("%6s %10s %8s %12s %12s %12s %10s %10s %9s", "grid", "instances", "unique", "placed", "instance MB",
+                                "sphere MB", "scene s", "TLAS s", "Mrays/s");
+        for (const u32 grid_extent : grid_extents)
+        {
+            HitableList* primitives = nullptr;
+            const f64 scene_seconds = time_seconds([&]() { primitives = generate_instanced_world(&pool, settings.seed, grid_extent); });
+
+            u64 nb_instances = 0u;
+            u64 nb_placed = 0u;
+            std::vector<const Hitable*> geometries;
+            for (u32 idx = 0u; idx < primitives->get_size(); ++idx)
+            {
+                const Instance* instance = dynamic_cast<const Instance*>((*primitives)[idx]);
+                if (!instance)
+                    continue;
+                const InstanceGeometry* geometry = static_cast<const InstanceGeometry*>(instance->get_object());
+                ++nb_instances;
+                nb_placed += geometry->get_nb_primitives();
+                if (std::find(geometries.begin(), geometries.end(), geometry) == geometries.end())
+                    geometries.push_back(geometry);
+            }
+            u64 nb_unique = 0u;
+            for (const Hitable* geometry : geometries)
+                nb_unique += static_cast<const InstanceGeometry*>(geometry)->get_nb_primitives();
+
+            BVHSettings bvh_settings;
+            bvh_settings.pool = &pool;
+            Hitable* tlas = nullptr;
+            const f64 tlas_seconds = time_seconds([&]() { tlas = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings); });
+
+            Renderer renderer(pool, settings);
+            Framebuffer framebuffer(settings.width, settings.height);
+            const RenderStats stats = renderer.render(camera, tlas, &framebuffer);
+
+            util::output_to_console("%6u %10llu %8llu %12llu %12.1f %12.1f %10.3f %10.3f %9.2f", grid_extent, nb_instances, nb_unique, nb_placed,
+                                    f64(nb_instances * sizeof(Instance)) / (1024. * 1024.), f64(nb_placed * sizeof(Sphere)) / (1024. * 1024.),
+                                    scene_seconds, tlas_seconds, f64(stats.nb_rays) / stats.seconds / 1e6);
+
+            util::safe_del(tlas);
+            util::safe_del(primitives);
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,94 @@
+// ======================================================================
+// File: numabench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/numa.h"
+#include "core/threadpool.h"
+#include "engine/scenes.h"
+
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    // Renders the same frame with the NUMA option off (free threads, framebuffer and
+    // scene touched by the main thread) and on (pinned workers, per-node tile bands,
+    // first-touched framebuffer, one scene replica per node) and compares throughput.
+    inline s32 run_numa(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 400u, 240u, 8u);
+        const std::string scene = _args.get_str("--scene", "random");
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const b32 is_replicated = !_args.has("--no-replicate");
+        const Camera camera = get_camera(settings);
+
+        const numa::Topology topology = numa::get_topology();
+        util::output_to_console("NUMA topology: %u nodes, %u cpus", topology.get_nb_nodes(), topology.get_nb_cpus());
+        for (u32 node = 0u; node < topology.get_nb_nodes(); ++node)
+            util::output_to_console("  node %u: %zu cpus", node, topology.node_cpus[node].size());
+
+        const u32 nb_threads = _args.get_u32("--threads", topology.get_nb_cpus());
+
+        struct Measure
+        {
+            f64 best_seconds = 0.;
+            u64 nb_rays = 0u;
+        };
+
+        auto measure = [&](ThreadPool& _pool, const std::vector<const Hitable*>& _worlds, b32 _is_first_touch, Framebuffer* framebuffer_)
+        {
+            Renderer renderer(_pool, settings);
+            Measure result;
+            for (u32 run = 0u; run < nb_runs; ++run)
+            {
+                Framebuffer framebuffer = _is_first_touch ? Framebuffer(settings.width, settings.height, Framebuffer::Uninitialized {})
+                                                          : Framebuffer(settings.width, settings.height);
+                const RenderStats stats = renderer.render(camera, _worlds, &framebuffer);
+                if (run == 0u || stats.seconds < result.best_seconds)
+                    result.best_seconds = stats.seconds;
+                result.nb_rays = stats.nb_rays;
+                *framebuffer_ = std::move(framebuffer);
+            }
+            return result;
+        };
+
+        Framebuffer image_off(settings.width, settings.height);
+        Measure off;
+        {
+            ThreadPool pool(nb_threads);
+            Hitable* world = generate_scene(scene, settings.seed);
+            off = measure(pool, { world }, false, &image_off);
+            util::safe_del(world);
+        }
+
+        Framebuffer image_on(settings.width, settings.height);
+        Measure on;
+        {
+            ThreadPool pool(topology, nb_threads);
+            std::vector<Hitable*> worlds = is_replicated ? generate_scene_replicas(pool, scene, settings.seed)
+                                                         : std::vector<Hitable*> { generate_scene(scene, settings.seed) };
+            on = measure(pool, std::vector<const Hitable*>(worlds.begin(), worlds.end()), true, &image_on);
+            for (Hitable*& world : worlds)
+                util::safe_del(world);
+        }
+
+        const f64 mrays_off = f64(off.nb_rays) / off.best_seconds / 1e6;
+        const f64 mrays_on  = f64(on.nb_rays) / on.best_seconds / 1e6;
+        util::output_to_console("NUMA off: %.3fs %.2f Mrays/s (best of %u)", off.best_seconds, mrays_off, nb_runs);
+        util::output_to_console("NUMA on:  %.3fs %.2f Mrays/s (best of %u, %s)", on.best_seconds, mrays_on, nb_runs,
+                                is_replicated ? "scene replicated per node" : "shared scene");
+        util::output_to_console("Speedup: %.2fx", off.best_seconds / on.best_seconds);
+
+        const b32 is_same = is_same_image(image_off, image_on);
+        if (!is_same)
+            util::output_to_console("ERROR: images differ between NUMA off and on");
+        return is_same ? 0 : 1;
+    }
+}
@@ -0,0 +1,134 @@
+// ======================================================================
+// File: occlusionbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "engine/bvhfactory.h"
+#include "engine/scenes.h"
+
+#include <limits>
+#include <vector>
+
+namespace bench
+{
+    // Shadow rays from every camera hit of the random scene towards a spherical light above
+    // it, answered per BVH layout by a closest hit, by occluded() and by the batched
+    // occluded() in batches of --batch consecutive pixels. One thread, rays/s and node
+    // visits per ray of each; the three have to agree on every ray.
+    inline s32 run_occlusion(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 320u, 200u, 1u);
+        const u32 batch_size = math::max(_args.get_u32("--batch", 256u), 1u);
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const Camera camera = get_camera(settings);
+        const fv3 light_center(4.f, 12.f, 3.f);
+        constexpr f32 k_light_radius = 2.f;
+
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        HitableList* primitives = generate_rand_world(&pool, settings.seed, _args.get_u32("--grid", 40u));
+
+        BVHSettings bvh_settings;
+        bvh_settings.pool = &pool;
+        std::vector<OcclusionQuery> queries;
+        {
+            Hitable* bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings);
+            Rng rng(settings.seed);
+            for (u32 y = 0u; y < settings.height; ++y)
+            {
+                for (u32 x = 0u; x < settings.width; ++x)
+                {
+                    const Ray camera_ray = camera.trace_ray((f32(x) + 0.5f) / f32(settings.width), (f32(y) + 0.5f) / f32(settings.height), rng);
+                    Hit hit;
+                    if (!bvh->hit(camera_ray, 0.f, 0.001f, std::numeric_limits<f32>::max(), &hit))
+                        continue;
+
+                    // A point inside the light's bounding cube, the query stops short of it
+                    const fv3 target = light_center + k_light_radius * fv3(2.f * rng.next_f32() - 1.f, 2.f * rng.next_f32() - 1.f, 2.f * rng.next_f32() - 1.f);
+                    OcclusionQuery query;
+                    query.ray = Ray(hit.point, target - hit.point);
+                    query.time = 0.f;
+                    query.zmin = 0.001f;
+                    query.zmax = (target - hit.point).get_length();
+                    queries.push_back(std::move(query));
+                }
+            }
+            util::safe_del(bvh);
+        }
+        const u32 nb_queries = u32(queries.size());
+        util::output_to_console("%u primitives, %u shadow rays from a %ux%u view, batches of %u, best of %u runs", primitives->get_size(),
+                                nb_queries, settings.width, settings.height, batch_size, nb_runs);
+
+        enum class Query { ClosestHit, AnyHit, Batched };
+        constexpr Query k_queries[] = { Query::ClosestHit, Query::AnyHit, Query::Batched };
+        constexpr const utf8* k_query_names[] = { "closest hit", "occluded", "batched" };
+        constexpr BVHLayout k_layouts[] = { BVHLayout::Pointer, BVHLayout::Flat, BVHLayout::Wide8 };
+
+        util::output_to_console("%-8s %-12s %10s %9s %12s %10s", "layout", "query", "ms", "Mrays/s", "visits/ray", "occluded");
+        BVHTraversalStats::set_enabled(true);
+        std::vector<b32> reference;
+        std::vector<b32> results(nb_queries, false);
+        s32 exit_code = 0;
+        for (const BVHLayout layout : k_layouts)
+        {
+            bvh_settings.layout = layout;
+            Hitable* bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings);
+            for (const Query query_kind : k_queries)
+            {
+                f64 best_seconds = std::numeric_limits<f64>::max();
+                u64 nb_visits = 0u;
+                for (u32 run = 0u; run < nb_runs; ++run)
+                {
+                    BVHTraversalStats::reset();
+                    best_seconds = math::min(best_seconds, time_seconds([&]()
+                    {
+                        if (query_kind == Query::Batched)
+                        {
+                            for (u32 first = 0u; first < nb_queries; first += batch_size)
+                                bvh->occluded(&queries[first], math::min(batch_size, nb_queries - first), &results[first]);
+                            return;
+                        }
+                        for (u32 idx = 0u; idx < nb_queries; ++idx)
+                        {
+                            const OcclusionQuery& query = queries[idx];
+                            Hit hit;
+                            results[idx] = (query_kind == Query::AnyHit) ? bvh->occluded(query.ray, query.time, query.zmin, query.zmax)
+                                                                          : bvh->hit(query.ray, query.time, query.zmin, query.zmax, &hit);
+                        }
+                    }));
+                    nb_visits = BVHTraversalStats::get_nb_node_visits();
+                }
+
+                u32 nb_occluded = 0u;
+                for (const b32 is_occluded : results)
+                    nb_occluded += is_occluded ? 1u : 0u;
+                util::output_to_console("%-8s %-12s %10.3f %9.2f %12.2f %10u", get_name(layout), k_query_names[static_cast<u32>(query_kind)],
+                                        best_seconds * 1e3, f64(nb_queries) / best_seconds / 1e6, f64(nb_visits) / f64(math::max(nb_queries, 1u)),
+                                        nb_occluded);
+
+                if (reference.empty())
+                {
+                    reference = results;
+                }
+                else if (results != reference)
+                {
+                    util::output_to_console("MISMATCH: %s %s disagrees with the pointer tree's closest hits", get_name(layout),
+                                            k_query_names[static_cast<u32>(query_kind)]);
+                    exit_code = 1;
+                }
+            }
+            util::safe_del(bvh);
+        }
+        BVHTraversalStats::set_enabled(false);
+
+        util::safe_del(primitives);
+        return exit_code;
+    }
+}
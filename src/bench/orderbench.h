@@ -0,0 +1,88 @@
+// ======================================================================
+// File: orderbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/threadpool.h"
+#include "engine/scenes.h"
+
+#include <string>
+
+namespace bench
+{
+    // Renders the same frame with every tile/pixel traversal order and reports time
+    // and cache misses per ray, to pick the default order from measurements.
+    inline s32 run_order(const Args& _args)
+    {
+        RenderSettings settings = get_settings(_args, 400u, 240u, 8u);
+        settings.use_perf_counters = true;
+        const std::string scene = _args.get_str("--scene", "random");
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const Camera camera = get_camera(settings);
+
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        Hitable* world = generate_scene(scene, settings.seed);
+
+        constexpr TileOrder k_tile_orders[] = { TileOrder::Scanline, TileOrder::Morton, TileOrder::Hilbert };
+        constexpr PixelOrder k_pixel_orders[] = { PixelOrder::Scanline, PixelOrder::Morton };
+
+        s32 exit_code = 0;
+        Framebuffer reference(settings.width, settings.height);
+        f64 best_seconds = 0.;
+        std::string best_name;
+
+        util::output_to_console("%-10s %-10s %9s %9s %12s %12s", "tiles", "pixels", "seconds", "Mrays/s", "L1D/ray", "LLC/ray");
+        for (const TileOrder tile_order : k_tile_orders)
+        {
+            for (const PixelOrder pixel_order : k_pixel_orders)
+            {
+                settings.tile_order = tile_order;
+                settings.pixel_order = pixel_order;
+                Renderer renderer(pool, settings);
+
+                RenderStats best;
+                Framebuffer framebuffer(settings.width, settings.height);
+                for (u32 run = 0u; run < nb_runs; ++run)
+                {
+                    const RenderStats stats = renderer.render(camera, world, &framebuffer);
+                    if (run == 0u || stats.seconds < best.seconds)
+                        best = stats;
+                }
+
+                const b32 has_counters = best.cache.has_l1d || best.cache.has_llc;
+                const f64 nb_rays = f64(math::max(best.nb_rays, 1ull));
+                util::output_to_console("%-10s %-10s %9.3f %9.2f %12s %12s", get_name(tile_order), get_name(pixel_order),
+                                        best.seconds, f64(best.nb_rays) / best.seconds / 1e6,
+                                        best.cache.has_l1d ? std::to_string(f64(best.cache.l1d_misses) / nb_rays).c_str() : "n/a",
+                                        best.cache.has_llc ? std::to_string(f64(best.cache.llc_misses) / nb_rays).c_str() : "n/a");
+                if (!has_counters && tile_order == TileOrder::Scanline && pixel_order == PixelOrder::Scanline)
+                    util::output_to_console("  (hardware counters unavailable on this platform/kernel, timing only)");
+
+                if (best_name.empty() || best.seconds < best_seconds)
+                {
+                    best_seconds = best.seconds;
+                    best_name = std::string(get_name(tile_order)) + "/" + get_name(pixel_order);
+                }
+
+                // Traversal order must never change the image
+                if (tile_order == TileOrder::Scanline && pixel_order == PixelOrder::Scanline)
+                    reference = std::move(framebuffer);
+                else if (!is_same_image(reference, framebuffer))
+                {
+                    util::output_to_console("ERROR: image differs for %s/%s", get_name(tile_order), get_name(pixel_order));
+                    exit_code = 1;
+                }
+            }
+        }
+        util::output_to_console("Fastest order: %s", best_name.c_str());
+
+        util::safe_del(world);
+        return exit_code;
+    }
+}
@@ -0,0 +1,96 @@
+// ======================================================================
+// File: outlierbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/threadpool.h"
+#include "engine/bvhfactory.h"
+#include "engine/scenes.h"
+
+namespace bench
+{
+    // The random scene per SAH layout with its 1000-radius ground sphere inside the tree, as
+    // every build did before OutlierBVH, and in the outlier list; then with an infinite ground
+    // plane, which can only be in the list. Node visits per ray and rays/s of each; no SAH
+    // cost, it is relative to each tree's root box and the sphere alone makes that box much
+    // bigger. The ground sphere has to give the same image either way.
+    inline s32 run_outliers(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 400u, 240u, 8u);
+        const u32 nb_runs = math::max(_args.get_u32("--runs", 3u), 1u);
+        const u32 grid_extent = _args.get_u32("--grid", 10u);
+        const Camera camera = get_camera(settings);
+
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        HitableList* sphere_ground = generate_rand_world(&pool, settings.seed, grid_extent);
+        HitableList* plane_ground = generate_rand_world(&pool, settings.seed, grid_extent, true);
+        util::output_to_console("%u primitives, %ux%u at %u spp, best of %u runs", sphere_ground->get_size(), settings.width, settings.height,
+                                settings.nb_samples, nb_runs);
+
+        enum class Ground { SphereInTree, SphereOutlier, Plane };
+        constexpr Ground k_grounds[] = { Ground::SphereInTree, Ground::SphereOutlier, Ground::Plane };
+        constexpr const utf8* k_ground_names[] = { "sphere, in tree", "sphere, outlier", "plane" };
+        constexpr BVHLayout k_layouts[] = { BVHLayout::Pointer, BVHLayout::Flat, BVHLayout::Wide8 };
+
+        util::output_to_console("%-8s %-16s %8s %11s %9s %9s %8s", "layout", "ground", "outliers", "visits/ray", "seconds", "Mrays/s", "speedup");
+        Renderer renderer(pool, settings);
+        s32 exit_code = 0;
+        for (const BVHLayout layout : k_layouts)
+        {
+            Framebuffer reference(settings.width, settings.height);
+            f64 in_tree_seconds = 0.;
+            for (const Ground ground : k_grounds)
+            {
+                BVHSettings bvh_settings;
+                bvh_settings.pool = &pool;
+                bvh_settings.layout = layout;
+                bvh_settings.outlier_area_ratio = (ground == Ground::SphereInTree) ? 0.f : bvh_settings.outlier_area_ratio;
+                HitableList* primitives = (ground == Ground::Plane) ? plane_ground : sphere_ground;
+                Hitable* bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings);
+                const OutlierBVH* outlier_bvh = dynamic_cast<const OutlierBVH*>(bvh);
+
+                Framebuffer framebuffer(settings.width, settings.height);
+                RenderStats best;
+                for (u32 run = 0u; run < nb_runs; ++run)
+                {
+                    const RenderStats stats = renderer.render(camera, bvh, &framebuffer);
+                    if (run == 0u || stats.seconds < best.seconds)
+                        best = stats;
+                }
+
+                // Counted on a separate render so the timed ones stay uninstrumented
+                BVHTraversalStats::reset();
+                BVHTraversalStats::set_enabled(true);
+                const RenderStats counted = renderer.render(camera, bvh, &framebuffer);
+                BVHTraversalStats::set_enabled(false);
+                const f64 visits_per_ray = f64(BVHTraversalStats::get_nb_node_visits()) / f64(math::max(counted.nb_rays, u64(1u)));
+
+                if (ground == Ground::SphereInTree)
+                    in_tree_seconds = best.seconds;
+                util::output_to_console("%-8s %-16s %8u %11.2f %9.3f %9.2f %7.2fx", get_name(layout), k_ground_names[static_cast<u32>(ground)],
+                                        outlier_bvh ? u32(outlier_bvh->get_outliers().size()) : 0u, visits_per_ray, best.seconds, f64(best.nb_rays) / best.seconds / 1e6, in_tree_seconds / best.seconds);
+
+                if (ground == Ground::SphereInTree)
+                {
+                    reference = std::move(framebuffer);
+                }
+                else if (ground == Ground::SphereOutlier && !is_same_image(reference, framebuffer))
+                {
+                    util::output_to_console("ERROR: image differs for %s with the ground sphere out of the tree", get_name(layout));
+                    exit_code = 1;
+                }
+                util::safe_del(bvh);
+            }
+        }
+
+        util::safe_del(plane_ground);
+        util::safe_del(sphere_ground);
+        return exit_code;
+    }
+}
@@ -0,0 +1,113 @@
+// ======================================================================
+// File: refitbench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/threadpool.h"
+#include "engine/bvhfactory.h"
+#include "engine/dynamicbvh.h"
+#include "engine/scenes.h"
+
+#include <limits>
+
+namespace bench
+{
+    // Swirls the random scene over a number of frames and keeps three BVHs up to date: a
+    // DynamicBVH with the rebuild threshold, one that only ever refits and a full SAH build
+    // per frame. All three keep the ground sphere in the outlier list, as the renderer does,
+    // so their SAH costs are over the same primitives. Update time and SAH cost of each; the
+    // dynamic tree's frame has to match the rebuilt one's pixel for pixel.
+    inline s32 run_refit(const Args& _args)
+    {
+        const RenderSettings settings = get_settings(_args, 160u, 100u, 1u);
+        const u32 nb_frames = math::max(_args.get_u32("--frames", 8u), 2u);
+        const f32 nb_turns = f32(_args.get_f64("--turns", 2.));
+        const Camera camera = get_camera(settings);
+
+        ThreadPool pool(_args.get_u32("--threads", 0u));
+        HitableList* primitives = generate_rand_world(&pool, settings.seed, _args.get_u32("--grid", 40u));
+        SceneAnimation animation(primitives);
+
+        BVHSettings bvh_settings;
+        bvh_settings.pool = &pool;
+        bvh_settings.rebuild_ratio = f32(_args.get_f64("--bvh-rebuild-ratio", bvh_settings.rebuild_ratio));
+        BVHSettings refit_settings = bvh_settings;
+        refit_settings.rebuild_ratio = std::numeric_limits<f32>::max();
+
+        // Built like an animated scene's world: a DynamicBVH beside the outlier list
+        auto create_dynamic_world = [&](const BVHSettings& _settings)
+        {
+            SceneBuild scene;
+            scene.primitives = primitives;
+            scene.use_bvh = true;
+            build_scene_bvh(&scene, _settings, true);
+            return scene.world;
+        };
+        auto get_dynamic_bvh = [](Hitable* _world)
+        {
+            if (const OutlierBVH* outlier_bvh = dynamic_cast<const OutlierBVH*>(_world))
+                _world = outlier_bvh->get_bvh();
+            return static_cast<DynamicBVH*>(_world);
+        };
+
+        s32 exit_code = 0;
+        Hitable* dynamic_world = create_dynamic_world(bvh_settings);
+        Hitable* refit_world = create_dynamic_world(refit_settings);
+        DynamicBVH& dynamic_bvh = *get_dynamic_bvh(dynamic_world);
+        DynamicBVH& refit_bvh = *get_dynamic_bvh(refit_world);
+        {
+            util::output_to_console("%u primitives, %u frames, rebuild ratio %.2f, %ux%u at %u spp", primitives->get_size(), nb_frames,
+                                    bvh_settings.rebuild_ratio, settings.width, settings.height, settings.nb_samples);
+
+            util::output_to_console("%5s %-8s %9s %9s %9s %11s %11s %11s %11s", "frame", "update", "ms", "SAH cost", "rebuilt",
+                                    "refit ms", "refit SAH", "rebuild ms", "rebuild SAH");
+            f64 dynamic_seconds = 0.;
+            f64 refit_seconds = 0.;
+            f64 rebuild_seconds = 0.;
+            Renderer renderer(pool, settings);
+            for (u32 frame = 1u; frame < nb_frames; ++frame)
+            {
+                animation.set_time(nb_turns * f32(frame) / f32(nb_frames));
+
+                const DynamicBVH::UpdateStats stats = dynamic_bvh.update();
+                const DynamicBVH::UpdateStats refit_stats = refit_bvh.update();
+                Hitable* rebuilt_bvh = nullptr;
+                const f64 seconds = time_seconds([&]() { rebuilt_bvh = create_bvh(primitives->get_buffer(), primitives->get_size(), 0.f, 1.f, bvh_settings); });
+                dynamic_seconds += stats.seconds;
+                refit_seconds += refit_stats.seconds;
+                rebuild_seconds += seconds;
+
+                util::output_to_console("%5u %-8s %9.3f %9.4f %9u %11.3f %11.4f %11.3f %11.4f", frame, get_name(stats.update), stats.seconds * 1e3,
+                                        stats.sah_cost, stats.nb_rebuilt_primitives, refit_stats.seconds * 1e3, refit_stats.sah_cost, seconds * 1e3,
+                                        get_bvh_sah_cost(rebuilt_bvh, bvh_settings.traversal_cost));
+
+                // Refitted or rebuilt, the tree must find the same surfaces
+                Framebuffer dynamic_frame(settings.width, settings.height);
+                Framebuffer rebuilt_frame(settings.width, settings.height);
+                renderer.render(camera, dynamic_world, &dynamic_frame);
+                renderer.render(camera, rebuilt_bvh, &rebuilt_frame);
+                if (!is_same_image(dynamic_frame, rebuilt_frame))
+                {
+                    util::output_to_console("ERROR: frame %u differs between the dynamic and the rebuilt BVH", frame);
+                    exit_code = 1;
+                }
+                util::safe_del(rebuilt_bvh);
+            }
+
+            util::output_to_console("Total update time: %.3f ms dynamic, %.3f ms refit only, %.3f ms full rebuilds", dynamic_seconds * 1e3,
+                                    refit_seconds * 1e3, rebuild_seconds * 1e3);
+        }
+
+        // The trees go before the primitives they point to
+        util::safe_del(refit_world);
+        util::safe_del(dynamic_world);
+        util::safe_del(primitives);
+        return exit_code;
+    }
+}
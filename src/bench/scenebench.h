@@ -0,0 +1,76 @@
+// ======================================================================
+// File: scenebench.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "bench/bench.h"
+
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "engine/scenes.h"
+
+#include <cstring>
+#include <vector>
+
+namespace bench
+{
+    // Hash of every primitive's bounds, in list order: equal hashes mean the same scene
+    inline u64 hash_primitives(const HitableList& _list)
+    {
+        u64 hash = 0u;
+        for (u32 idx = 0u; idx < _list.get_size(); ++idx)
+        {
+            AABB box;
+            _list[idx]->compute_aabb(0.f, 1.f, &box);
+            const f32 values[6] = { box.min.x, box.min.y, box.min.z, box.max.x, box.max.y, box.max.z };
+            for (const f32 value : values)
+            {
+                u32 bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                hash = Rng::mix(hash ^ bits);
+            }
+        }
+        return hash;
+    }
+
+    // Times the random scene construction for growing thread counts and checks the
+    // resulting list is the same every time.
+    inline s32 run_scene(const Args& _args)
+    {
+        const u64 seed = _args.get_u64("--seed", RenderSettings {}.seed);
+        const u32 grid_extent = _args.get_u32("--grid", 200u);
+        const u32 max_threads = _args.get_u32("--threads", ThreadPool::get_default_nb_threads());
+
+        std::vector<u32> thread_counts;
+        for (u32 nb_threads = 1u; nb_threads < max_threads; nb_threads *= 2u)
+            thread_counts.push_back(nb_threads);
+        thread_counts.push_back(max_threads);
+
+        s32 exit_code = 0;
+        u64 reference_hash = 0u;
+        f64 serial_seconds = 0.;
+        for (const u32 nb_threads : thread_counts)
+        {
+            ThreadPool pool(nb_threads);
+            HitableList* list = nullptr;
+            const f64 seconds = time_seconds([&]() { list = generate_rand_world(&pool, seed, grid_extent); });
+            const u64 hash = hash_primitives(*list);
+
+            if (nb_threads == thread_counts.front())
+            {
+                reference_hash = hash;
+                serial_seconds = seconds;
+            }
+            util::output_to_console("%2u threads: %u primitives in %.3fs (%.2fx) hash %016llx%s", nb_threads, list->get_size(), seconds,
+                                    serial_seconds / seconds, hash, (hash == reference_hash) ? "" : " MISMATCH");
+            exit_code = (hash == reference_hash) ? exit_code : 1;
+
+            util::safe_del(list);
+        }
+        return exit_code;
+    }
+}
@@ -0,0 +1,88 @@
+// ======================================================================
+// File: args.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Minimal command line reader: "--flag" switches and "--key value" pairs.
+class Args
+{
+public:
+    inline Args(s32 _argc, utf8** _argv);
+
+    inline b32 has(const std::string& _flag) const;
+    inline std::string get_str(const std::string& _key, const std::string& _default) const;
+    inline u32 get_u32(const std::string& _key, u32 _default) const;
+    inline u64 get_u64(const std::string& _key, u64 _default) const;
+    inline f64 get_f64(const std::string& _key, f64 _default) const;
+
+    inline const std::string& get_program() const;
+    inline const std::vector<std::string>& get_all() const; // including the program
+
+private:
+    inline const std::string* find_value(const std::string& _key) const;
+
+private:
+    std::vector<std::string> m_args;
+};
+
+inline Args::Args(s32 _argc, utf8** _argv)
+    : m_args(_argv, _argv + _argc)
+{
+}
+
+inline b32 Args::has(const std::string& _flag) const
+{
+    return std::find(m_args.begin() + 1, m_args.end(), _flag) != m_args.end();
+}
+
+inline std::string Args::get_str(const std::string& _key, const std::string& _default) const
+{
+    const std::string* value = find_value(_key);
+    return value ? *value : _default;
+}
+
+inline u32 Args::get_u32(const std::string& _key, u32 _default) const
+{
+    const std::string* value = find_value(_key);
+    return value ? u32(std::stoul(*value)) : _default;
+}
+
+inline u64 Args::get_u64(const std::string& _key, u64 _default) const
+{
+    const std::string* value = find_value(_key);
+    return value ? u64(std::stoull(*value, nullptr, 0)) : _default;
+}
+
+inline f64 Args::get_f64(const std::string& _key, f64 _default) const
+{
+    const std::string* value = find_value(_key);
+    return value ? std::stod(*value) : _default;
+}
+
+inline const std::string& Args::get_program() const
+{
+    return m_args.front();
+}
+
+inline const std::vector<std::string>& Args::get_all() const
+{
+    return m_args;
+}
+
+inline const std::string* Args::find_value(const std::string& _key) const
+{
+    const auto it = std::find(m_args.begin() + 1, m_args.end(), _key);
+    if (it == m_args.end() || it + 1 == m_args.end() || (it + 1)->rfind("--", 0) == 0)
+        return nullptr;
+    return &*(it + 1);
+}
@@ -0,0 +1,167 @@
+// ======================================================================
+// File: mappedfile.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+#include "core/utils.h"
+
+#include <filesystem>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file. Pages are loaded by the OS on first touch and shared with
+// every other process mapping the same file, nothing is copied into the process up front.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    inline MappedFile(MappedFile&& _other) noexcept;
+    inline MappedFile& operator=(MappedFile&& _other) noexcept;
+    inline ~MappedFile();
+
+    inline b32 open(const std::filesystem::path& _path);
+    inline void close();
+
+    inline b32 is_open() const;
+    inline const u8* get_data() const;
+    inline usize get_size() const;
+
+    // Drops the file's pages from the OS cache so the next mapping reads them from disk again.
+    // Linux only, false where it is not supported.
+    static inline b32 evict_from_page_cache(const std::filesystem::path& _path);
+
+private:
+    const u8* m_data = nullptr;
+    usize m_size = 0u;
+};
+
+inline MappedFile::MappedFile(MappedFile&& _other) noexcept
+    : m_data(std::exchange(_other.m_data, nullptr))
+    , m_size(std::exchange(_other.m_size, 0u))
+{
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& _other) noexcept
+{
+    if (this != std::addressof(_other))
+    {
+        close();
+        m_data = std::exchange(_other.m_data, nullptr);
+        m_size = std::exchange(_other.m_size, 0u);
+    }
+    return *this;
+}
+
+inline MappedFile::~MappedFile()
+{
+    close();
+}
+
+inline b32 MappedFile::open(const std::filesystem::path& _path)
+{
+    close();
+#if defined(_WIN32)
+    const HANDLE file = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    // The view keeps the mapping alive, neither handle is needed past this point
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+        return false;
+    m_data = static_cast<const u8*>(data);
+    m_size = usize(size.QuadPart);
+#else
+    const int fd = ::open(_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, usize(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    m_data = static_cast<const u8*>(data);
+    m_size = usize(info.st_size);
+#endif
+    return true;
+}
+
+inline void MappedFile::close()
+{
+    if (!m_data)
+        return;
+#if defined(_WIN32)
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<u8*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0u;
+}
+
+inline b32 MappedFile::is_open() const
+{
+    return m_data != nullptr;
+}
+
+inline const u8* MappedFile::get_data() const
+{
+    return m_data;
+}
+
+inline usize MappedFile::get_size() const
+{
+    return m_size;
+}
+
+inline b32 MappedFile::evict_from_page_cache(const std::filesystem::path& _path)
+{
+#if defined(__linux__)
+    const int fd = ::open(_path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    // Clean pages only, which a file that is just read always has
+    fdatasync(fd);
+    const b32 is_evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return is_evicted;
+#else
+    return false;
+#endif
+}
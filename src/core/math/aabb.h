@@ -14,6 +14,8 @@
 
 #include <algorithm>
 
+#include <xmmintrin.h>
+
 class AABB
 {
     //MOVABLE_ONLY( AABB );
@@ -24,7 +26,12 @@ public:
 
     constexpr void set(const fv3& _min, const fv3& _max);
 
-    constexpr b32 is_hit(const Ray& _ray, f32 _tmin, f32 _tmax) const;
+    inline b32 is_hit(const Ray& _ray, f32 _tmin, f32 _tmax) const;
+    // Same test on a box held in two vectors (x, y, z, ignored)
+    static inline b32 is_hit(__m128 _min, __m128 _max, const Ray& _ray, f32 _tmin, f32 _tmax);
+
+    constexpr fv3 get_center() const;
+    constexpr f32 get_surface_area() const;
 
     static constexpr AABB get_surrounding_box(const AABB& _boxA, const AABB& _boxB);
 
@@ -45,22 +52,42 @@ constexpr void AABB::set(const fv3& _min, const fv3& _max)
     max = _max;
 }
 
-constexpr b32 AABB::is_hit(const Ray& _ray, f32 _tmin, f32 _tmax) const
+inline b32 AABB::is_hit(const Ray& _ray, f32 _tmin, f32 _tmax) const
+{
+    return is_hit(_mm_setr_ps(min.x, min.y, min.z, 0.f), _mm_setr_ps(max.x, max.y, max.z, 0.f), _ray, _tmin, _tmax);
+}
+
+inline b32 AABB::is_hit(__m128 _min, __m128 _max, const Ray& _ray, f32 _tmin, f32 _tmax)
+{
+    // The three slabs at once and no early out. The ray's reciprocal is finite, so every
+    // lane is a number and min/max need no NaN ordering. Subtracting the origin first keeps
+    // far-off boxes finite, bound * inv alone overflows past |bound| ~ 3e8 with inv at 1e30
+    const __m128 inv_dir = _mm_load_ps(_ray.inv_direction);
+    const __m128 origin = _mm_load_ps(_ray.slab_origin);
+    const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_min, origin), inv_dir);
+    const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_max, origin), inv_dir);
+    const __m128 tnear = _mm_min_ps(t0, t1);
+    const __m128 tfar = _mm_max_ps(t0, t1);
+
+    // Horizontal reduction of lanes x, y, z into lane 0, lane 3 is never read
+    __m128 tmin = _mm_max_ss(_mm_max_ss(tnear, _mm_shuffle_ps(tnear, tnear, _MM_SHUFFLE(1, 1, 1, 1))),
+                             _mm_shuffle_ps(tnear, tnear, _MM_SHUFFLE(2, 2, 2, 2)));
+    __m128 tmax = _mm_min_ss(_mm_min_ss(tfar, _mm_shuffle_ps(tfar, tfar, _MM_SHUFFLE(1, 1, 1, 1))),
+                             _mm_shuffle_ps(tfar, tfar, _MM_SHUFFLE(2, 2, 2, 2)));
+    tmin = _mm_max_ss(tmin, _mm_set_ss(_tmin));
+    tmax = _mm_min_ss(tmax, _mm_set_ss(_tmax));
+    return _mm_comilt_ss(tmin, tmax);
+}
+
+constexpr fv3 AABB::get_center() const
+{
+    return 0.5f * (min + max);
+}
+
+constexpr f32 AABB::get_surface_area() const
 {
-    for (usize i = 0u; i < 3u; ++i)
-    {
-        const f32 inv_dir = math::inv(_ray.direction[i]);
-        const f32 t0 = math::min((min[i] - _ray.origin[i]) * inv_dir,
-                                 (max[i] - _ray.origin[i]) * inv_dir);
-        const f32 t1 = math::max((min[i] - _ray.origin[i]) * inv_dir,
-                                 (max[i] - _ray.origin[i]) * inv_dir);
-
-        _tmin = math::max(t0, _tmin);
-        _tmax = math::min(t1, _tmax);
-        if (_tmax <= _tmin)
-            return false;
-    }
-    return true;
+    const fv3 extent = max - min;
+    return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
 }
 
 constexpr AABB AABB::get_surrounding_box(const AABB& _boxA, const AABB& _boxB)
@@ -0,0 +1,139 @@
+// ======================================================================
+// File: affine.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/math/aabb.h"
+#include "core/math/math.h"
+#include "core/math/v3.h"
+#include "core/utils.h"
+
+// 3D affine map as a row-major 3x4 matrix: p' = linear * p + translation. Vectors skip the
+// translation, normals go through the transposed linear part of the inverse map.
+class Affine
+{
+public:
+    constexpr Affine() = default; // identity
+    constexpr Affine(const fv3& _row0, const fv3& _row1, const fv3& _row2, const fv3& _translation);
+
+    static constexpr Affine from_translation(const fv3& _offset);
+    static constexpr Affine from_scale(const fv3& _scale);
+    static inline Affine from_rotation(const fv3& _axis, f32 _angle); // right-handed, radians
+
+    // _other first, then this
+    constexpr Affine operator*(const Affine& _other) const;
+
+    constexpr fv3 transform_point(const fv3& _p) const;
+    constexpr fv3 transform_vector(const fv3& _v) const;
+    // Call on the inverse map, the result is not normalised
+    constexpr fv3 transform_normal(const fv3& _n) const;
+    // Tight box around the transformed corners
+    constexpr AABB transform_box(const AABB& _box) const;
+
+    constexpr f32 get_determinant() const;
+    inline Affine get_inverse() const;
+
+public:
+    fv3 rows[3] = { fv3(1.f, 0.f, 0.f), fv3(0.f, 1.f, 0.f), fv3(0.f, 0.f, 1.f) };
+    fv3 translation = {};
+};
+
+constexpr Affine::Affine(const fv3& _row0, const fv3& _row1, const fv3& _row2, const fv3& _translation)
+    : rows { _row0, _row1, _row2 }
+    , translation(_translation)
+{
+}
+
+constexpr Affine Affine::from_translation(const fv3& _offset)
+{
+    Affine affine;
+    affine.translation = _offset;
+    return affine;
+}
+
+constexpr Affine Affine::from_scale(const fv3& _scale)
+{
+    return Affine(fv3(_scale.x, 0.f, 0.f), fv3(0.f, _scale.y, 0.f), fv3(0.f, 0.f, _scale.z), fv3(0.f));
+}
+
+inline Affine Affine::from_rotation(const fv3& _axis, f32 _angle)
+{
+    // Rodrigues: cos * I + sin * [axis]x + (1 - cos) * axis axis^T
+    const fv3 a = _axis.get_normalized();
+    const f32 c = math::cos(_angle);
+    const f32 s = math::sin(_angle);
+    const f32 t = 1.f - c;
+    return Affine(fv3(c + t * a.x * a.x,       t * a.x * a.y - s * a.z, t * a.x * a.z + s * a.y),
+                  fv3(t * a.x * a.y + s * a.z, c + t * a.y * a.y,       t * a.y * a.z - s * a.x),
+                  fv3(t * a.x * a.z - s * a.y, t * a.y * a.z + s * a.x, c + t * a.z * a.z),
+                  fv3(0.f));
+}
+
+constexpr Affine Affine::operator*(const Affine& _other) const
+{
+    const fv3 col0(_other.rows[0].x, _other.rows[1].x, _other.rows[2].x);
+    const fv3 col1(_other.rows[0].y, _other.rows[1].y, _other.rows[2].y);
+    const fv3 col2(_other.rows[0].z, _other.rows[1].z, _other.rows[2].z);
+    Affine result;
+    for (u32 row = 0u; row < 3u; ++row)
+        result.rows[row] = fv3(math::dot(rows[row], col0), math::dot(rows[row], col1), math::dot(rows[row], col2));
+    result.translation = transform_point(_other.translation);
+    return result;
+}
+
+constexpr fv3 Affine::transform_point(const fv3& _p) const
+{
+    return transform_vector(_p) + translation;
+}
+
+constexpr fv3 Affine::transform_vector(const fv3& _v) const
+{
+    return fv3(math::dot(rows[0], _v), math::dot(rows[1], _v), math::dot(rows[2], _v));
+}
+
+constexpr fv3 Affine::transform_normal(const fv3& _n) const
+{
+    return _n.x * rows[0] + _n.y * rows[1] + _n.z * rows[2];
+}
+
+constexpr AABB Affine::transform_box(const AABB& _box) const
+{
+    // Per output axis, each input axis adds whichever of its two extremes lands lower (Arvo)
+    fv3 min = translation;
+    fv3 max = translation;
+    for (u32 row = 0u; row < 3u; ++row)
+    {
+        for (u32 col = 0u; col < 3u; ++col)
+        {
+            const f32 a = rows[row][col] * _box.min[col];
+            const f32 b = rows[row][col] * _box.max[col];
+            min[row] += math::min(a, b);
+            max[row] += math::max(a, b);
+        }
+    }
+    return AABB(min, max);
+}
+
+constexpr f32 Affine::get_determinant() const
+{
+    return math::dot(rows[0], math::cross(rows[1], rows[2]));
+}
+
+inline Affine Affine::get_inverse() const
+{
+    // Rows of the inverse linear part are the cross products of the columns, over the determinant
+    const f32 det = get_determinant();
+    sws_assert(det != 0.f);
+    const f32 inv_det = math::inv(det);
+    const fv3 col0(rows[0].x, rows[1].x, rows[2].x);
+    const fv3 col1(rows[0].y, rows[1].y, rows[2].y);
+    const fv3 col2(rows[0].z, rows[1].z, rows[2].z);
+
+    Affine inverse(inv_det * math::cross(col1, col2), inv_det * math::cross(col2, col0), inv_det * math::cross(col0, col1), fv3(0.f));
+    inverse.translation = -inverse.transform_vector(translation);
+    return inverse;
+}
@@ -0,0 +1,117 @@
+// ======================================================================
+// File: curves.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+
+namespace math
+{
+    /**
+     * Spreads the 16 low bits of _x over the even bits of the result (0b1011 -> 0b1000101).
+     */
+    constexpr u32 part_1by1(u32 _x)
+    {
+        _x &= 0x0000ffffu;
+        _x = (_x | (_x << 8u)) & 0x00ff00ffu;
+        _x = (_x | (_x << 4u)) & 0x0f0f0f0fu;
+        _x = (_x | (_x << 2u)) & 0x33333333u;
+        _x = (_x | (_x << 1u)) & 0x55555555u;
+        return _x;
+    }
+
+    /**
+     * Inverse of part_1by1: gathers the even bits of _x into the 16 low bits.
+     */
+    constexpr u32 compact_1by1(u32 _x)
+    {
+        _x &= 0x55555555u;
+        _x = (_x | (_x >> 1u)) & 0x33333333u;
+        _x = (_x | (_x >> 2u)) & 0x0f0f0f0fu;
+        _x = (_x | (_x >> 4u)) & 0x00ff00ffu;
+        _x = (_x | (_x >> 8u)) & 0x0000ffffu;
+        return _x;
+    }
+
+    /**
+     * Returns the Z-order (Morton) index of (_x, _y), both coordinates below 2^16.
+     */
+    constexpr u32 morton_encode_2d(u32 _x, u32 _y)
+    {
+        return part_1by1(_x) | (part_1by1(_y) << 1u);
+    }
+
+    /**
+     * Returns the coordinates of the Z-order (Morton) index _code.
+     */
+    constexpr void morton_decode_2d(u32 _code, u32* x_, u32* y_)
+    {
+        *x_ = compact_1by1(_code);
+        *y_ = compact_1by1(_code >> 1u);
+    }
+
+    /**
+     * Spreads the 10 low bits of _x over every third bit of the result (0b1011 -> 0b1000001001).
+     */
+    constexpr u32 part_1by2(u32 _x)
+    {
+        _x &= 0x000003ffu;
+        _x = (_x | (_x << 16u)) & 0x030000ffu;
+        _x = (_x | (_x << 8u))  & 0x0300f00fu;
+        _x = (_x | (_x << 4u))  & 0x030c30c3u;
+        _x = (_x | (_x << 2u))  & 0x09249249u;
+        return _x;
+    }
+
+    /**
+     * Returns the 30-bit Z-order (Morton) index of (_x, _y, _z), each coordinate below 2^10.
+     */
+    constexpr u32 morton_encode_3d(u32 _x, u32 _y, u32 _z)
+    {
+        return part_1by2(_x) | (part_1by2(_y) << 1u) | (part_1by2(_z) << 2u);
+    }
+
+    /**
+     * Returns the distance along the Hilbert curve filling a _side x _side grid of (_x, _y).
+     * @param _side Grid size, must be a power of two.
+     */
+    constexpr u32 hilbert_encode_2d(u32 _side, u32 _x, u32 _y)
+    {
+        u32 d = 0u;
+        for (u32 s = _side >> 1u; s > 0u; s >>= 1u)
+        {
+            const u32 rx = (_x & s) ? 1u : 0u;
+            const u32 ry = (_y & s) ? 1u : 0u;
+            d += s * s * ((3u * rx) ^ ry);
+
+            // Rotate the quadrant so the sub-curve is in canonical orientation
+            if (ry == 0u)
+            {
+                if (rx == 1u)
+                {
+                    _x = s - 1u - (_x & (s - 1u));
+                    _y = s - 1u - (_y & (s - 1u));
+                }
+                const u32 t = _x;
+                _x = _y;
+                _y = t;
+            }
+        }
+        return d;
+    }
+
+    /**
+     * Returns the smallest power of two greater or equal than _x (1 for 0).
+     */
+    constexpr u32 next_pow2(u32 _x)
+    {
+        u32 p = 1u;
+        while (p < _x)
+            p <<= 1u;
+        return p;
+    }
+}
@@ -195,7 +195,7 @@ namespace math
      * @param _max    High boundary.
      */
     template <class T>
-    constexpr const T& clamp(T _x, T _min, T _max)
+    constexpr T clamp(T _x, T _min, T _max)
     {
         return math::clamp(_x, _min, _max, std::less<>());
     }
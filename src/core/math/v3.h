@@ -18,7 +18,7 @@ public:
     constexpr v3() noexcept                                       : x(0), y(0), z(0) {}
     explicit constexpr v3(T _s) noexcept                          : x(_s), y(_s), z(_s) {}
     explicit constexpr v3(T _x, T _y, T _z) noexcept              : x(_x), y(_y), z(_z) {}
-    explicit constexpr v3(const v2<T>& _xy, T _z = T(0)) noexcept : xy(_xy), z(_z) {}
+    explicit constexpr v3(const v2<T>& _xy, T _z = T(0)) noexcept : x(_xy.x), y(_xy.y), z(_z) {}
 
     template <typename S>
     constexpr v3<S> cast() const { return v3<S>(S(x), S(y), S(z)); }
@@ -87,9 +87,6 @@ public:
     inline void normalize() noexcept;
     inline void clear() noexcept;
     
-    constexpr v2<T>& get_xy() { return xy; }
-    constexpr v2<T>& get_yz() { return yz; }
-
     template<auto _axis>
     constexpr T get() const;
 
@@ -439,7 +436,7 @@ constexpr T v3<T>::get() const
 }
 
 template <class T>
-inline v3<T> operator*(T _s, const v3<T>& _v)
+constexpr v3<T> operator*(T _s, const v3<T>& _v)
 {
     return _v.operator*(_s);
 }
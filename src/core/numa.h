@@ -0,0 +1,154 @@
+// ======================================================================
+// File: numa.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#include <filesystem>
+#endif
+
+// NUMA topology discovery and thread pinning. Falls back to a single node
+// holding every hardware thread where the platform exposes nothing.
+namespace numa
+{
+    struct Topology
+    {
+        inline u32 get_nb_nodes() const { return u32(node_cpus.size()); }
+        inline u32 get_nb_cpus() const;
+
+        std::vector<std::vector<u32>> node_cpus; // logical cpu ids per node
+    };
+
+    inline u32 Topology::get_nb_cpus() const
+    {
+        u32 nb_cpus = 0u;
+        for (const std::vector<u32>& cpus : node_cpus)
+            nb_cpus += u32(cpus.size());
+        return nb_cpus;
+    }
+
+    namespace internal
+    {
+        // Parses lists such as "0-3,8-11"
+        inline std::vector<u32> parse_cpu_list(const std::string& _list)
+        {
+            std::vector<u32> cpus;
+            usize pos = 0u;
+            while (pos < _list.size())
+            {
+                const usize comma = std::min(_list.find(',', pos), _list.size());
+                const std::string range = _list.substr(pos, comma - pos);
+                const usize dash = range.find('-');
+                if (!range.empty() && range[0] >= '0' && range[0] <= '9')
+                {
+                    const u32 first = u32(std::stoul(range.substr(0u, dash)));
+                    const u32 last = (dash != std::string::npos) ? u32(std::stoul(range.substr(dash + 1u))) : first;
+                    for (u32 cpu = first; cpu <= last; ++cpu)
+                        cpus.push_back(cpu);
+                }
+                pos = comma + 1u;
+            }
+            return cpus;
+        }
+    }
+
+    inline Topology get_topology()
+    {
+        Topology topology;
+
+#if defined(_WIN32)
+        ULONG highest_node = 0u;
+        if (GetNumaHighestNodeNumber(&highest_node))
+        {
+            for (USHORT node = 0u; node <= USHORT(highest_node); ++node)
+            {
+                GROUP_AFFINITY affinity = {};
+                if (!GetNumaNodeProcessorMaskEx(node, &affinity) || affinity.Mask == 0u)
+                    continue;
+
+                std::vector<u32> cpus;
+                for (u32 bit = 0u; bit < 64u; ++bit)
+                {
+                    if (affinity.Mask & (KAFFINITY(1) << bit))
+                        cpus.push_back(u32(affinity.Group) * 64u + bit);
+                }
+                topology.node_cpus.push_back(std::move(cpus));
+            }
+        }
+#elif defined(__linux__)
+        namespace fs = std::filesystem;
+        const fs::path nodes_path("/sys/devices/system/node");
+        std::error_code error;
+        if (fs::exists(nodes_path, error))
+        {
+            std::vector<std::pair<u32, std::vector<u32>>> nodes;
+            for (const fs::directory_entry& entry : fs::directory_iterator(nodes_path, error))
+            {
+                const std::string name = entry.path().filename().string();
+                if (name.rfind("node", 0) != 0 || name.size() <= 4u || name[4] < '0' || name[4] > '9')
+                    continue;
+
+                std::ifstream file_stream(entry.path() / "cpulist");
+                std::string list;
+                if (std::getline(file_stream, list))
+                {
+                    std::vector<u32> cpus = internal::parse_cpu_list(list);
+                    if (!cpus.empty())
+                        nodes.emplace_back(u32(std::stoul(name.substr(4u))), std::move(cpus));
+                }
+            }
+            std::sort(nodes.begin(), nodes.end(), [](const auto& _a, const auto& _b) { return _a.first < _b.first; });
+            for (auto& node : nodes)
+                topology.node_cpus.push_back(std::move(node.second));
+        }
+#endif
+
+        if (topology.node_cpus.empty())
+        {
+            std::vector<u32> cpus(std::max(std::thread::hardware_concurrency(), 1u));
+            for (u32 cpu = 0u; cpu < u32(cpus.size()); ++cpu)
+                cpus[cpu] = cpu;
+            topology.node_cpus.push_back(std::move(cpus));
+        }
+        return topology;
+    }
+
+    inline b32 pin_current_thread(u32 _cpu)
+    {
+#if defined(_WIN32)
+        GROUP_AFFINITY affinity = {};
+        affinity.Group = WORD(_cpu / 64u);
+        affinity.Mask = KAFFINITY(1) << (_cpu % 64u);
+        return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#elif defined(__linux__)
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(_cpu, &cpu_set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,139 @@
+// ======================================================================
+// File: perfcounters.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+#include "core/utils.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+// Hardware cache-miss counters of the calling thread, read through perf_event_open
+// on Linux. Elsewhere, or when the kernel refuses (perf_event_paranoid, containers,
+// VMs without PMU passthrough), start() fails and every value reads as unavailable.
+class PerfCounters
+{
+    NON_COPYABLE(PerfCounters);
+
+public:
+    struct Values
+    {
+        inline Values& operator+=(const Values& _other);
+
+        u64 l1d_misses = 0u;
+        u64 llc_misses = 0u;
+        b32 has_l1d    = false;
+        b32 has_llc    = false;
+    };
+
+public:
+    PerfCounters() = default;
+    inline ~PerfCounters();
+
+    // Opens, resets and enables the counters for the calling thread
+    inline b32 start();
+    inline Values read() const;
+    inline void stop();
+
+private:
+    enum : u32 { k_l1d, k_llc, k_nb_counters };
+
+    s32 m_fds[k_nb_counters] = { -1, -1 };
+};
+
+// PerfCounters::Values //
+
+inline PerfCounters::Values& PerfCounters::Values::operator+=(const Values& _other)
+{
+    l1d_misses += _other.l1d_misses;
+    llc_misses += _other.llc_misses;
+    has_l1d = has_l1d || _other.has_l1d;
+    has_llc = has_llc || _other.has_llc;
+    return *this;
+}
+
+// PerfCounters //
+
+inline PerfCounters::~PerfCounters()
+{
+    stop();
+}
+
+inline b32 PerfCounters::start()
+{
+    stop();
+
+#if defined(__linux__)
+    auto open_counter = [](u32 _type, u64 _config) -> s32
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = _type;
+        attr.config = _config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // pid 0, cpu -1: the calling thread on whatever cpu it runs
+        return s32(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    };
+
+    m_fds[k_l1d] = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8u) |
+                                                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u));
+    m_fds[k_llc] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    b32 is_any_open = false;
+    for (const s32 fd : m_fds)
+    {
+        if (fd < 0)
+            continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        is_any_open = true;
+    }
+    return is_any_open;
+#else
+    return false;
+#endif
+}
+
+inline PerfCounters::Values PerfCounters::read() const
+{
+    Values values;
+#if defined(__linux__)
+    u64 count = 0u;
+    if (m_fds[k_l1d] >= 0 && ::read(m_fds[k_l1d], &count, sizeof(count)) == sizeof(count))
+    {
+        values.l1d_misses = count;
+        values.has_l1d = true;
+    }
+    if (m_fds[k_llc] >= 0 && ::read(m_fds[k_llc], &count, sizeof(count)) == sizeof(count))
+    {
+        values.llc_misses = count;
+        values.has_llc = true;
+    }
+#endif
+    return values;
+}
+
+inline void PerfCounters::stop()
+{
+#if defined(__linux__)
+    for (s32& fd : m_fds)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+#endif
+}
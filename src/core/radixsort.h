@@ -0,0 +1,71 @@
+// ======================================================================
+// File: radixsort.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/threadpool.h"
+#include "core/types.h"
+
+#include <vector>
+
+namespace util
+{
+    /**
+     * Stable LSD radix sort of _keys on bits [_first_bit, _first_bit + _nb_bits), 8 bits per pass.
+     * With a pool, each pass histograms and scatters contiguous chunks in parallel; chunk
+     * offsets are laid out in chunk order so the result is the same as the serial sort.
+     */
+    inline void radix_sort(std::vector<u64>* keys_, u32 _first_bit, u32 _nb_bits, ThreadPool* _pool = nullptr)
+    {
+        constexpr u32 k_radix_bits = 8u;
+        constexpr u32 k_nb_buckets = 1u << k_radix_bits;
+        constexpr u32 k_min_chunk_size = 16384u;
+
+        std::vector<u64>& keys = *keys_;
+        const u32 count = u32(keys.size());
+        const u32 nb_chunks = _pool ? math::max(math::min(2u * _pool->get_nb_threads(), count / k_min_chunk_size), 1u) : 1u;
+        auto run_chunks = [&](const std::function<void(u32 _chunk, u32 _begin, u32 _end)>& _fn)
+        {
+            if (nb_chunks > 1u)
+                _pool->parallel_for(count, nb_chunks, _fn);
+            else
+                _fn(0u, 0u, count);
+        };
+
+        std::vector<u64> tmp(count);
+        std::vector<u32> offsets(nb_chunks * k_nb_buckets);
+        for (u32 shift = _first_bit; shift < _first_bit + _nb_bits; shift += k_radix_bits)
+        {
+            run_chunks([&](u32 _chunk, u32 _begin, u32 _end)
+            {
+                u32* histogram = &offsets[_chunk * k_nb_buckets];
+                std::fill(histogram, histogram + k_nb_buckets, 0u);
+                for (u32 idx = _begin; idx < _end; ++idx)
+                    ++histogram[(keys[idx] >> shift) & (k_nb_buckets - 1u)];
+            });
+
+            u32 sum = 0u;
+            for (u32 bucket = 0u; bucket < k_nb_buckets; ++bucket)
+            {
+                for (u32 chunk = 0u; chunk < nb_chunks; ++chunk)
+                {
+                    const u32 nb_keys = offsets[chunk * k_nb_buckets + bucket];
+                    offsets[chunk * k_nb_buckets + bucket] = sum;
+                    sum += nb_keys;
+                }
+            }
+
+            run_chunks([&](u32 _chunk, u32 _begin, u32 _end)
+            {
+                u32* offset = &offsets[_chunk * k_nb_buckets];
+                for (u32 idx = _begin; idx < _end; ++idx)
+                    tmp[offset[(keys[idx] >> shift) & (k_nb_buckets - 1u)]++] = keys[idx];
+            });
+            keys.swap(tmp);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+// ======================================================================
+// File: rng.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/types.h"
+
+// PCG32 (XSH-RR) generator. Small enough to be created per pixel sample:
+// seeding it from (seed, pixel, sample, dimension) makes every sample
+// independent from the order in which the workers process them. The
+// dimension selects one of the sample's independent streams.
+class Rng
+{
+public:
+    constexpr Rng() noexcept;
+    constexpr explicit Rng(u64 _seed, u64 _stream = 0u) noexcept;
+
+    static constexpr Rng from_sample(u64 _seed, u32 _pixel, u32 _sample, u32 _dimension = 0u) noexcept;
+    static constexpr u64 mix(u64 _x) noexcept;
+
+    constexpr u32 next_u32() noexcept;
+    constexpr u64 next_u64() noexcept;
+    constexpr u32 next_bounded(u32 _bound) noexcept;
+    constexpr f32 next_f32() noexcept;
+    constexpr f64 next_f64() noexcept;
+
+private:
+    static constexpr u64 k_multiplier = 6364136223846793005ull;
+    static constexpr u64 k_default_seed = 0x853c49e6748fea9bull;
+
+    u64 m_state = 0u;
+    u64 m_inc   = 1u;
+};
+
+constexpr Rng::Rng() noexcept
+    : Rng(k_default_seed)
+{
+}
+
+constexpr Rng::Rng(u64 _seed, u64 _stream) noexcept
+    : m_state(0u)
+    , m_inc((_stream << 1u) | 1u)
+{
+    next_u32();
+    m_state += _seed;
+    next_u32();
+}
+
+constexpr Rng Rng::from_sample(u64 _seed, u32 _pixel, u32 _sample, u32 _dimension) noexcept
+{
+    const u64 key = mix((u64(_pixel) << 32u) | u64(_sample));
+    const u64 state = mix(_seed ^ key);
+    const u64 stream = mix(state + 0x9e3779b97f4a7c15ull * (u64(_dimension) + 1u));
+    return Rng(state, stream);
+}
+
+// SplitMix64 finalizer, turns structured keys (indices, counters) into well spread seeds.
+constexpr u64 Rng::mix(u64 _x) noexcept
+{
+    _x ^= _x >> 30u;
+    _x *= 0xbf58476d1ce4e5b9ull;
+    _x ^= _x >> 27u;
+    _x *= 0x94d049bb133111ebull;
+    _x ^= _x >> 31u;
+    return _x;
+}
+
+constexpr u32 Rng::next_u32() noexcept
+{
+    const u64 old_state = m_state;
+    m_state = old_state * k_multiplier + m_inc;
+    const u32 xor_shifted = u32(((old_state >> 18u) ^ old_state) >> 27u);
+    const u32 rot = u32(old_state >> 59u);
+    return (xor_shifted >> rot) | (xor_shifted << ((0u - rot) & 31u));
+}
+
+constexpr u64 Rng::next_u64() noexcept
+{
+    const u64 hi = next_u32();
+    return (hi << 32u) | next_u32();
+}
+
+// Lemire's multiply-shift reduction, the small bias is irrelevant for rendering.
+constexpr u32 Rng::next_bounded(u32 _bound) noexcept
+{
+    return u32((u64(next_u32()) * u64(_bound)) >> 32u);
+}
+
+constexpr f32 Rng::next_f32() noexcept
+{
+    // 24 random mantissa bits -> [0, 1)
+    return f32(next_u32() >> 8u) * (1.f / 16777216.f);
+}
+
+constexpr f64 Rng::next_f64() noexcept
+{
+    // 53 random mantissa bits -> [0, 1)
+    return f64(next_u64() >> 11u) * (1. / 9007199254740992.);
+}
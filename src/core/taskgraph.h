@@ -0,0 +1,229 @@
+// ======================================================================
+// File: taskgraph.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/threadpool.h"
+#include "core/types.h"
+#include "core/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Directed acyclic graph of named tasks. A task is submitted to the pool as soon as
+// its last dependency finishes, so independent branches run at the same time.
+// After run(), print_report() shows when every task ran and the critical path,
+// the chain of dependencies that bounded the total time.
+class TaskGraph
+{
+    NON_COPYABLE(TaskGraph);
+
+public:
+    using TaskId = u32;
+    using Fn = std::function<void()>;
+
+public:
+    TaskGraph() = default;
+
+    inline TaskId add(const std::string& _name, Fn&& _fn, std::initializer_list<TaskId> _dependencies = {});
+    inline void add_dependency(TaskId _task, TaskId _dependency);
+
+    // Blocks until every task ran. Must not be called from a worker of _pool.
+    // Returns false, running nothing, when the dependencies contain a cycle.
+    inline b32 run(ThreadPool& _pool);
+
+    inline f64 get_wall_seconds() const;
+    inline f64 get_critical_path_seconds() const;
+    inline void print_report() const;
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    struct Task
+    {
+        std::string name;
+        Fn fn;
+        std::vector<TaskId> dependencies;
+        std::vector<TaskId> successors;
+        std::atomic<u32> nb_remaining = 0u;
+        f64 start_seconds = 0.;
+        f64 end_seconds   = 0.;
+        u32 worker = ThreadPool::k_invalid_worker;
+    };
+
+    inline b32 sort_topologically(std::vector<TaskId>* order_) const;
+    inline void execute(ThreadPool& _pool, TaskId _id);
+    inline std::vector<TaskId> find_critical_path() const;
+
+private:
+    std::vector<std::unique_ptr<Task>> m_tasks;
+    Clock::time_point m_start;
+    f64 m_wall_seconds = 0.;
+};
+
+inline TaskGraph::TaskId TaskGraph::add(const std::string& _name, Fn&& _fn, std::initializer_list<TaskId> _dependencies)
+{
+    const TaskId id = TaskId(m_tasks.size());
+    m_tasks.emplace_back(std::make_unique<Task>());
+    m_tasks.back()->name = _name;
+    m_tasks.back()->fn = std::move(_fn);
+    for (const TaskId dependency : _dependencies)
+        add_dependency(id, dependency);
+    return id;
+}
+
+inline void TaskGraph::add_dependency(TaskId _task, TaskId _dependency)
+{
+    sws_assert(_task < m_tasks.size() && _dependency < m_tasks.size() && _task != _dependency);
+    m_tasks[_task]->dependencies.push_back(_dependency);
+    m_tasks[_dependency]->successors.push_back(_task);
+}
+
+inline b32 TaskGraph::run(ThreadPool& _pool)
+{
+    sws_assert(ThreadPool::get_worker_index() == ThreadPool::k_invalid_worker);
+
+    std::vector<TaskId> order;
+    if (!sort_topologically(&order))
+    {
+        util::output_to_console("Task graph has a dependency cycle, nothing was run");
+        return false;
+    }
+
+    for (std::unique_ptr<Task>& task : m_tasks)
+        task->nb_remaining.store(u32(task->dependencies.size()), std::memory_order_relaxed);
+
+    m_start = Clock::now();
+    for (TaskId id = 0u; id < TaskId(m_tasks.size()); ++id)
+    {
+        if (m_tasks[id]->dependencies.empty())
+            _pool.submit([this, &_pool, id]() { execute(_pool, id); });
+    }
+    // Successors are submitted from inside their last dependency, the pool never drains early
+    _pool.wait();
+    m_wall_seconds = std::chrono::duration<f64>(Clock::now() - m_start).count();
+    return true;
+}
+
+inline f64 TaskGraph::get_wall_seconds() const
+{
+    return m_wall_seconds;
+}
+
+inline f64 TaskGraph::get_critical_path_seconds() const
+{
+    f64 seconds = 0.;
+    for (const TaskId id : find_critical_path())
+        seconds += m_tasks[id]->end_seconds - m_tasks[id]->start_seconds;
+    return seconds;
+}
+
+inline void TaskGraph::print_report() const
+{
+    f64 work_seconds = 0.;
+    for (const std::unique_ptr<Task>& task : m_tasks)
+        work_seconds += task->end_seconds - task->start_seconds;
+
+    const std::vector<TaskId> critical_path = find_critical_path();
+    std::vector<b32> is_critical(m_tasks.size(), false);
+    for (const TaskId id : critical_path)
+        is_critical[id] = true;
+
+    util::output_to_console("Task graph: %zu tasks, wall %.3fs, work %.3fs, parallelism %.2fx",
+                            m_tasks.size(), m_wall_seconds, work_seconds,
+                            (m_wall_seconds > 0.) ? work_seconds / m_wall_seconds : 0.);
+    for (const std::unique_ptr<Task>& task : m_tasks)
+    {
+        util::output_to_console("  %c [%8.3f -> %8.3f] %8.3fs  thread %2u  %s",
+                                is_critical[&task - &m_tasks[0]] ? '*' : ' ',
+                                task->start_seconds, task->end_seconds, task->end_seconds - task->start_seconds,
+                                task->worker, task->name.c_str());
+    }
+
+    std::string chain;
+    for (const TaskId id : critical_path)
+        chain += (chain.empty() ? "" : " -> ") + m_tasks[id]->name;
+    const f64 critical_seconds = get_critical_path_seconds();
+    util::output_to_console("Critical path %.3fs (%.1f%% of wall): %s", critical_seconds,
+                            (m_wall_seconds > 0.) ? 100. * critical_seconds / m_wall_seconds : 0., chain.c_str());
+}
+
+inline b32 TaskGraph::sort_topologically(std::vector<TaskId>* order_) const
+{
+    std::vector<u32> nb_remaining(m_tasks.size());
+    order_->clear();
+    for (TaskId id = 0u; id < TaskId(m_tasks.size()); ++id)
+    {
+        nb_remaining[id] = u32(m_tasks[id]->dependencies.size());
+        if (nb_remaining[id] == 0u)
+            order_->push_back(id);
+    }
+
+    for (usize idx = 0u; idx < order_->size(); ++idx)
+    {
+        for (const TaskId successor : m_tasks[(*order_)[idx]]->successors)
+        {
+            if (--nb_remaining[successor] == 0u)
+                order_->push_back(successor);
+        }
+    }
+    return order_->size() == m_tasks.size();
+}
+
+inline void TaskGraph::execute(ThreadPool& _pool, TaskId _id)
+{
+    Task& task = *m_tasks[_id];
+    task.worker = ThreadPool::get_worker_index();
+    task.start_seconds = std::chrono::duration<f64>(Clock::now() - m_start).count();
+    task.fn();
+    task.end_seconds = std::chrono::duration<f64>(Clock::now() - m_start).count();
+
+    for (const TaskId successor : task.successors)
+    {
+        // acq_rel: the successor sees everything its dependencies wrote
+        if (m_tasks[successor]->nb_remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+            _pool.submit([this, &_pool, successor]() { execute(_pool, successor); });
+    }
+}
+
+inline std::vector<TaskGraph::TaskId> TaskGraph::find_critical_path() const
+{
+    std::vector<TaskId> order;
+    if (m_tasks.empty() || !sort_topologically(&order))
+        return {};
+
+    // Longest chain by measured duration: finish[t] = duration[t] + max(finish[dependency])
+    std::vector<f64> finish(m_tasks.size(), 0.);
+    std::vector<TaskId> previous(m_tasks.size(), TaskId(~0u));
+    TaskId last = order.front();
+    for (const TaskId id : order)
+    {
+        const Task& task = *m_tasks[id];
+        f64 longest = 0.;
+        for (const TaskId dependency : task.dependencies)
+        {
+            if (previous[id] == TaskId(~0u) || finish[dependency] > longest)
+            {
+                longest = finish[dependency];
+                previous[id] = dependency;
+            }
+        }
+        finish[id] = longest + (task.end_seconds - task.start_seconds);
+        if (finish[id] > finish[last])
+            last = id;
+    }
+
+    std::vector<TaskId> path;
+    for (TaskId id = last; id != TaskId(~0u); id = previous[id])
+        path.insert(path.begin(), id);
+    return path;
+}
@@ -0,0 +1,386 @@
+// ======================================================================
+// File: threadpool.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/numa.h"
+#include "core/types.h"
+#include "core/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of workers, each owning a job deque. A worker pops its own
+// jobs from the front and, when empty, steals from the back of the others.
+// Built from a NUMA topology, workers are pinned to cores and steal from the
+// workers of their own node before crossing to a remote one.
+class ThreadPool
+{
+    NON_COPYABLE(ThreadPool);
+
+public:
+    using Job = std::function<void()>;
+
+    struct WorkerStats
+    {
+        u64 busy_ns   = 0u;
+        u64 nb_jobs   = 0u;
+        u64 nb_stolen = 0u;
+    };
+
+public:
+    inline explicit ThreadPool(u32 _nb_threads = 0u);
+    inline ThreadPool(const numa::Topology& _topology, u32 _nb_threads = 0u);
+    inline ~ThreadPool();
+
+    inline void submit(Job&& _job);
+    inline void submit_to(u32 _worker_idx, Job&& _job);
+    inline void submit_pinned(u32 _worker_idx, Job&& _job); // never stolen
+    inline void wait();
+
+    // Fork-join wait for a subset of jobs that decrement _nb_remaining when done. The calling
+    // thread, worker or not, runs queued jobs meanwhile, so nested waits cannot deadlock.
+    inline void wait_for(const std::atomic<u32>& _nb_remaining);
+
+    // Splits [0, _count) into _nb_chunks contiguous ranges, runs _fn(chunk, begin, end) for each
+    // on the pool and returns once all of them are done
+    inline void parallel_for(u32 _count, u32 _nb_chunks, const std::function<void(u32 _chunk, u32 _begin, u32 _end)>& _fn);
+
+    inline u32 get_nb_threads() const;
+    inline u32 get_nb_nodes() const;
+    inline u32 get_worker_node(u32 _worker_idx) const;
+    inline b32 is_pinned() const;
+    inline std::vector<WorkerStats> get_stats() const;
+    inline void reset_stats();
+
+    // Index of the calling thread in whichever pool it belongs to
+    static inline u32 get_worker_index();
+    // Index of the calling thread in this pool, k_invalid_worker from any other thread
+    inline u32 get_current_worker() const;
+    static inline u32 get_default_nb_threads();
+
+    static constexpr u32 k_invalid_worker = ~0u;
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::deque<Job> pinned_jobs;
+        std::vector<u32> victims; // steal order, same node first
+        std::thread thread;
+        WorkerStats stats;
+        std::atomic<u32> nb_pinned = 0u; // pinned_jobs' size, for the sleep predicate
+        u32 node = 0u;
+        u32 cpu  = k_invalid_worker;
+    };
+
+    inline void start(u32 _nb_threads, const numa::Topology* _topology);
+    inline void push(u32 _worker_idx, Job&& _job, b32 _is_pinned);
+    inline void worker_loop(u32 _idx);
+    inline b32 try_run_one(u32 _idx);
+    inline b32 pop_local(u32 _idx, Job* job_, b32* is_pinned_);
+    inline b32 steal(u32 _idx, Job* job_);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+    std::condition_variable m_done_cv;
+
+    std::atomic<u32> m_nb_queued  = 0u; // stealable jobs sitting in any deque, pinned ones count per worker
+    std::atomic<u32> m_nb_pending = 0u; // jobs submitted and not finished yet
+    std::atomic<u32> m_next_worker = 0u;
+    u32 m_nb_nodes = 1u;
+    b32 m_stop = false;
+
+    static inline thread_local u32 s_worker_idx = k_invalid_worker;
+    static inline thread_local const ThreadPool* s_worker_pool = nullptr;
+};
+
+inline ThreadPool::ThreadPool(u32 _nb_threads)
+{
+    start((_nb_threads > 0u) ? _nb_threads : get_default_nb_threads(), nullptr);
+}
+
+inline ThreadPool::ThreadPool(const numa::Topology& _topology, u32 _nb_threads)
+{
+    start((_nb_threads > 0u) ? _nb_threads : math::max(_topology.get_nb_cpus(), 1u), &_topology);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep_cv.notify_all();
+
+    for (std::unique_ptr<Worker>& worker : m_workers)
+        worker->thread.join();
+}
+
+inline void ThreadPool::submit(Job&& _job)
+{
+    // Jobs spawned from inside a worker stay local, everything else is spread round-robin
+    const u32 current = get_current_worker();
+    const u32 idx = (current != k_invalid_worker) ? current : m_next_worker++ % get_nb_threads();
+    submit_to(idx, std::move(_job));
+}
+
+inline void ThreadPool::submit_to(u32 _worker_idx, Job&& _job)
+{
+    push(_worker_idx, std::move(_job), false);
+}
+
+inline void ThreadPool::submit_pinned(u32 _worker_idx, Job&& _job)
+{
+    push(_worker_idx, std::move(_job), true);
+}
+
+inline void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_sleep_mutex);
+    m_done_cv.wait(lock, [this]() { return m_nb_pending.load(std::memory_order_acquire) == 0u; });
+}
+
+inline void ThreadPool::wait_for(const std::atomic<u32>& _nb_remaining)
+{
+    const u32 idx = get_current_worker();
+    while (_nb_remaining.load(std::memory_order_acquire) != 0u)
+    {
+        if (!try_run_one(idx))
+            std::this_thread::yield();
+    }
+}
+
+inline void ThreadPool::parallel_for(u32 _count, u32 _nb_chunks, const std::function<void(u32 _chunk, u32 _begin, u32 _end)>& _fn)
+{
+    _nb_chunks = math::max(math::min(_nb_chunks, _count), 1u);
+    std::atomic<u32> nb_remaining = _nb_chunks;
+    for (u32 chunk = 0u; chunk < _nb_chunks; ++chunk)
+    {
+        submit([&_fn, &nb_remaining, chunk, _count, _nb_chunks]()
+        {
+            _fn(chunk, u32(u64(_count) * chunk / _nb_chunks), u32(u64(_count) * (chunk + 1u) / _nb_chunks));
+            nb_remaining.fetch_sub(1u, std::memory_order_release);
+        });
+    }
+    wait_for(nb_remaining);
+}
+
+inline u32 ThreadPool::get_nb_threads() const
+{
+    return u32(m_workers.size());
+}
+
+inline u32 ThreadPool::get_nb_nodes() const
+{
+    return m_nb_nodes;
+}
+
+inline u32 ThreadPool::get_worker_node(u32 _worker_idx) const
+{
+    sws_assert(_worker_idx < get_nb_threads());
+    return m_workers[_worker_idx]->node;
+}
+
+inline b32 ThreadPool::is_pinned() const
+{
+    return !m_workers.empty() && m_workers.front()->cpu != k_invalid_worker;
+}
+
+inline std::vector<ThreadPool::WorkerStats> ThreadPool::get_stats() const
+{
+    std::vector<WorkerStats> stats;
+    stats.reserve(m_workers.size());
+    for (const std::unique_ptr<Worker>& worker : m_workers)
+        stats.push_back(worker->stats);
+    return stats;
+}
+
+inline void ThreadPool::reset_stats()
+{
+    wait();
+    for (std::unique_ptr<Worker>& worker : m_workers)
+        worker->stats = {};
+}
+
+inline u32 ThreadPool::get_worker_index()
+{
+    return s_worker_idx;
+}
+
+inline u32 ThreadPool::get_current_worker() const
+{
+    return (s_worker_pool == this) ? s_worker_idx : k_invalid_worker;
+}
+
+inline u32 ThreadPool::get_default_nb_threads()
+{
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+inline void ThreadPool::start(u32 _nb_threads, const numa::Topology* _topology)
+{
+    m_workers.reserve(_nb_threads);
+    for (u32 idx = 0u; idx < _nb_threads; ++idx)
+        m_workers.emplace_back(std::make_unique<Worker>());
+
+    if (_topology && _topology->get_nb_nodes() > 0u)
+    {
+        // Workers are laid out node by node, in equal shares, and cycle through the node's cores
+        m_nb_nodes = math::min(_topology->get_nb_nodes(), _nb_threads);
+        for (u32 idx = 0u; idx < _nb_threads; ++idx)
+        {
+            const u32 node = u32((u64(idx) * m_nb_nodes) / _nb_threads);
+            const u32 node_first = u32((u64(node) * _nb_threads + m_nb_nodes - 1u) / m_nb_nodes);
+            const std::vector<u32>& cpus = _topology->node_cpus[node];
+            m_workers[idx]->node = node;
+            m_workers[idx]->cpu = cpus[(idx - node_first) % cpus.size()];
+        }
+    }
+
+    for (u32 idx = 0u; idx < _nb_threads; ++idx)
+    {
+        std::vector<u32>& victims = m_workers[idx]->victims;
+        for (u32 pass = 0u; pass < 2u; ++pass)
+        {
+            for (u32 offset = 1u; offset < _nb_threads; ++offset)
+            {
+                const u32 victim = (idx + offset) % _nb_threads;
+                const b32 is_same_node = m_workers[victim]->node == m_workers[idx]->node;
+                if (is_same_node == (pass == 0u))
+                    victims.push_back(victim);
+            }
+        }
+    }
+
+    for (u32 idx = 0u; idx < _nb_threads; ++idx)
+        m_workers[idx]->thread = std::thread(&ThreadPool::worker_loop, this, idx);
+}
+
+inline void ThreadPool::push(u32 _worker_idx, Job&& _job, b32 _is_pinned)
+{
+    sws_assert(_worker_idx < get_nb_threads());
+
+    m_nb_pending.fetch_add(1u, std::memory_order_relaxed);
+    {
+        Worker& worker = *m_workers[_worker_idx];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        (_is_pinned ? worker.pinned_jobs : worker.jobs).emplace_back(std::move(_job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        (_is_pinned ? m_workers[_worker_idx]->nb_pinned : m_nb_queued).fetch_add(1u, std::memory_order_relaxed);
+    }
+    // A pinned job has a single possible taker, waking only one sleeper could miss it. The
+    // others find nothing for them in the predicate and go back to sleep
+    if (_is_pinned)
+        m_sleep_cv.notify_all();
+    else
+        m_sleep_cv.notify_one();
+}
+
+inline void ThreadPool::worker_loop(u32 _idx)
+{
+    s_worker_idx = _idx;
+    s_worker_pool = this;
+
+    if (m_workers[_idx]->cpu != k_invalid_worker)
+        numa::pin_current_thread(m_workers[_idx]->cpu);
+
+    // Only jobs this worker can take wake it: stealable ones or its own pinned ones
+    const std::atomic<u32>& nb_pinned = m_workers[_idx]->nb_pinned;
+    auto has_work = [this, &nb_pinned]()
+    {
+        return m_nb_queued.load(std::memory_order_relaxed) > 0u || nb_pinned.load(std::memory_order_relaxed) > 0u;
+    };
+    for (;;)
+    {
+        if (try_run_one(_idx))
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleep_cv.wait(lock, [this, &has_work]() { return m_stop || has_work(); });
+        if (m_stop && !has_work())
+            return;
+    }
+}
+
+// Runs one queued job: the worker's own first, else a stolen one. Threads outside the
+// pool (_idx invalid) only steal and keep no stats.
+inline b32 ThreadPool::try_run_one(u32 _idx)
+{
+    Job job;
+    b32 is_pinned = false;
+    const b32 is_local = (_idx != k_invalid_worker) && pop_local(_idx, &job, &is_pinned);
+    if (!is_local && !steal(_idx, &job))
+        return false;
+
+    (is_pinned ? m_workers[_idx]->nb_pinned : m_nb_queued).fetch_sub(1u, std::memory_order_relaxed);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    job();
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    if (_idx != k_invalid_worker)
+    {
+        WorkerStats& stats = m_workers[_idx]->stats;
+        stats.busy_ns += u64(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        stats.nb_jobs += 1u;
+        stats.nb_stolen += is_local ? 0u : 1u;
+    }
+
+    if (m_nb_pending.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_done_cv.notify_all();
+    }
+    return true;
+}
+
+inline b32 ThreadPool::pop_local(u32 _idx, Job* job_, b32* is_pinned_)
+{
+    Worker& worker = *m_workers[_idx];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    *is_pinned_ = !worker.pinned_jobs.empty();
+    std::deque<Job>& jobs = *is_pinned_ ? worker.pinned_jobs : worker.jobs;
+    if (jobs.empty())
+        return false;
+
+    *job_ = std::move(jobs.front());
+    jobs.pop_front();
+    return true;
+}
+
+inline b32 ThreadPool::steal(u32 _idx, Job* job_)
+{
+    const u32 nb_victims = (_idx != k_invalid_worker) ? u32(m_workers[_idx]->victims.size()) : get_nb_threads();
+    for (u32 victim_pos = 0u; victim_pos < nb_victims; ++victim_pos)
+    {
+        const u32 victim_idx = (_idx != k_invalid_worker) ? m_workers[_idx]->victims[victim_pos] : victim_pos;
+        Worker& victim = *m_workers[victim_idx];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty())
+            continue;
+
+        *job_ = std::move(victim.jobs.back());
+        victim.jobs.pop_back();
+        return true;
+    }
+    return false;
+}
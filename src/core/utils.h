@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/math/v3.h"
+#include "core/rng.h"
 
 #include <random>
 #include <sstream>
@@ -9,9 +10,12 @@
 #include <cstdarg>
 #include <cstdio>
 #include <filesystem>
+#include <utility>
 namespace fs = std::filesystem;
 
+#if defined(_MSC_VER)
 #define STBI_MSC_SECURE_CRT
+#endif
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
@@ -23,9 +27,9 @@ namespace fs = std::filesystem;
 #define MOVABLE_ONLY( CLS ) \
     public: \
     constexpr CLS (const CLS &) noexcept            = delete; \
-    constexpr CLS (CLS &&) noexcept                 = default; \
+    CLS (CLS &&) noexcept                           = default; \
     constexpr CLS & operator=(const CLS &) noexcept = delete; \
-    constexpr CLS & operator=(CLS &&) noexcept      = default \
+    CLS & operator=(CLS &&) noexcept                = default \
 
 template <class T>
 class In
@@ -51,52 +55,81 @@ namespace util
         }
     }
 
-    template <class T, ENABLE_IF(IS_REAL(T) || IS_INT(T))>
-    constexpr T rand(T _beg, T _end)
+    // Generator used by code that has no sampler state of its own (scene setup, noise tables)
+    inline Rng& get_thread_rng()
     {
-        static std::random_device rnd_device;
-        static std::mt19937_64 mt_engine(rnd_device());
+        static thread_local Rng rng(u64(std::random_device{}()) << 32u | std::random_device{}());
+        return rng;
+    }
 
+    template <class T, ENABLE_IF(IS_REAL(T) || IS_INT(T))>
+    constexpr T rand(Rng& _rng, T _beg, T _end)
+    {
         if constexpr(IS_REAL(T))
         {
-            std::uniform_real_distribution<T> distrib(_beg, _end);
-            return distrib(mt_engine);
+            return _beg + T(_rng.next_f64()) * (_end - _beg);
         }
         else if constexpr(IS_INT(T))
         {
-            std::uniform_int_distribution<T> distrib(_beg, _end);
-            return distrib(mt_engine);
+            const u64 range = u64(_end) - u64(_beg) + 1u;
+            if (range == 0u || range > u64(~0u))
+                return T(u64(_beg) + ((range == 0u) ? _rng.next_u64() : _rng.next_u64() % range));
+            return T(u64(_beg) + _rng.next_bounded(u32(range)));
         }
         return T(0);
     }
 
-    constexpr f64 drand_01()
+    template <class T, ENABLE_IF(IS_REAL(T) || IS_INT(T))>
+    inline T rand(T _beg, T _end)
+    {
+        return util::rand(get_thread_rng(), _beg, _end);
+    }
+
+    constexpr f64 drand_01(Rng& _rng)
+    {
+        return _rng.next_f64();
+    }
+
+    constexpr f32 frand_01(Rng& _rng)
     {
-        return util::rand(0., 1.);
+        return _rng.next_f32();
     }
 
-    constexpr f32 frand_01()
+    inline f64 drand_01()
     {
-        return util::rand(0.f, 1.f);
+        return drand_01(get_thread_rng());
+    }
+
+    inline f32 frand_01()
+    {
+        return frand_01(get_thread_rng());
     }
     
-    constexpr fv3 rand_unit_fv3()
+    constexpr fv3 rand_unit_fv3(Rng& _rng)
     {
-        return fv3(frand_01(), frand_01(), frand_01());
+        const f32 x = frand_01(_rng);
+        const f32 y = frand_01(_rng);
+        const f32 z = frand_01(_rng);
+        return fv3(x, y, z);
     }
     
-    constexpr fv3 rand_point_in_unit_sphere()
+    constexpr fv3 rand_point_in_unit_sphere(Rng& _rng)
     {
         fv3 point;
-        do point = 2.f * fv3(frand_01(), frand_01(), 0.f) - fv3(1.f, 1.f, 0.f);
+        do
+        {
+            const f32 x = frand_01(_rng);
+            const f32 y = frand_01(_rng);
+            point = 2.f * fv3(x, y, 0.f) - fv3(1.f, 1.f, 0.f);
+        }
         while (math::dot(point, point) >= 1.f);
         return point;
     }
     
-    constexpr fv3 rand_point_in_unit_disk()
+    constexpr fv3 rand_point_in_unit_disk(Rng& _rng)
     {
         fv3 point;
-        do point = 2.f * rand_unit_fv3() - fv3(1.f);
+        do point = 2.f * rand_unit_fv3(_rng) - fv3(1.f);
         while (point.get_sqrlength() >= 1.f);
         return point;
     }
@@ -105,8 +138,12 @@ namespace util
     {
         const std::time_t now = std::time(nullptr);
         std::tm local_buf = {};
+#if defined(_MSC_VER)
         const errno_t err = gmtime_s(&local_buf, &now);
         sws_assert(err == 0);
+#else
+        gmtime_r(&now, &local_buf); // only fails for years out of int range
+#endif
         std::stringstream ss;
         ss << std::put_time(&local_buf, "%y%m%d_%H%M%S");
         return ss.str();
@@ -124,8 +161,14 @@ namespace util
         {
             va_list args;
             va_start(args, _fmt);
+#if defined(_MSC_VER)
             const s32 n = _vsnprintf_s(out_buf, out_buf_sz - sizeof(end_line_chars) + 1,
                                        out_buf_sz - sizeof(end_line_chars), _fmt, args);
+#else
+            // vsnprintf returns the untruncated length, _vsnprintf_s stops at the count
+            const s32 n = math::min(vsnprintf(out_buf, out_buf_sz - sizeof(end_line_chars) + 1, _fmt, args),
+                                    s32(out_buf_sz - sizeof(end_line_chars)));
+#endif
             va_end(args);
             sws_assert(n >= 0);
 
@@ -154,13 +197,18 @@ namespace util
         return fs::path("out");
     }
 
-    inline b32 output_img_to_file(const std::string& _filename, u32 _width, u32 _height, const std::vector<rgb>& _data)
+    inline b32 output_img_to_file(const std::string& _filename, u32 _width, u32 _height, const rgb* _data)
     {
         if (!fs::exists(get_output_path()))
             fs::create_directory(get_output_path());
 
         const fs::path filepath = get_output_path() / (_filename + ".png");
-        return stbi_write_png(filepath.string().c_str(), _width, _height, 3, &_data[0], 0);
+        return stbi_write_png(filepath.string().c_str(), _width, _height, 3, _data, 0);
+    }
+
+    inline b32 output_img_to_file(const std::string& _filename, u32 _width, u32 _height, const std::vector<rgb>& _data)
+    {
+        return output_img_to_file(_filename, _width, _height, _data.data());
     }
 
     inline b32 output_img_to_incremental_file(u32 _width, u32 _height, const std::vector<rgb>& _data)
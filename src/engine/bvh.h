@@ -1,12 +1,214 @@
 #pragma once
 
+#include "core/radixsort.h"
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "core/math/aabb.h"
+#include "core/math/curves.h"
 #include "engine/hitable.h"
 
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <limits>
+#include <string>
+#include <vector>
+
+enum class BVHBuilder
+{
+    Median, // random axis, median split
+    SAH,    // binned surface area heuristic
+    LBVH,   // Morton-sorted linear BVH, fast build for scenes rebuilt every frame
+};
+
+inline const utf8* get_name(BVHBuilder _builder)
+{
+    switch (_builder)
+    {
+        case BVHBuilder::Median: return "median";
+        case BVHBuilder::SAH:    return "sah";
+        case BVHBuilder::LBVH:   return "lbvh";
+    }
+    return "unknown";
+}
+
+inline b32 parse_bvh_builder(const std::string& _name, BVHBuilder* builder_)
+{
+    for (const BVHBuilder builder : { BVHBuilder::Median, BVHBuilder::SAH, BVHBuilder::LBVH })
+    {
+        if (_name == get_name(builder))
+        {
+            *builder_ = builder;
+            return true;
+        }
+    }
+    return false;
+}
+
+enum class BVHLayout
+{
+    Pointer, // one heap-allocated Hitable per node
+    Flat,    // LinearBVH node array
+    Wide4,   // BVH4, SSE child tests
+    Wide8,   // BVH8, AVX child tests
+    Motion,  // MotionBVH node array, bounds interpolated at the ray's time
+};
+
+inline const utf8* get_name(BVHLayout _layout)
+{
+    switch (_layout)
+    {
+        case BVHLayout::Pointer: return "pointer";
+        case BVHLayout::Flat:    return "flat";
+        case BVHLayout::Wide4:   return "bvh4";
+        case BVHLayout::Wide8:   return "bvh8";
+        case BVHLayout::Motion:  return "motion";
+    }
+    return "unknown";
+}
+
+inline b32 parse_bvh_layout(const std::string& _name, BVHLayout* layout_)
+{
+    for (const BVHLayout layout : { BVHLayout::Pointer, BVHLayout::Flat, BVHLayout::Wide4, BVHLayout::Wide8, BVHLayout::Motion })
+    {
+        if (_name == get_name(layout))
+        {
+            *layout_ = layout;
+            return true;
+        }
+    }
+    return false;
+}
+
+enum class BVHTraversal
+{
+    Unordered, // children in tree order, each tested against the full ray range
+    Ordered,   // nearer child first, the far one is culled by the closest hit found
+};
+
+inline const utf8* get_name(BVHTraversal _traversal)
+{
+    return (_traversal == BVHTraversal::Ordered) ? "ordered" : "unordered";
+}
+
+inline b32 parse_bvh_traversal(const std::string& _name, BVHTraversal* traversal_)
+{
+    for (const BVHTraversal traversal : { BVHTraversal::Unordered, BVHTraversal::Ordered })
+    {
+        if (_name == get_name(traversal))
+        {
+            *traversal_ = traversal;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Node boxes tested by every BVH layout while enabled (a wide node counts once). Each
+// thread adds to its own slot; read the sum once the traversals are done.
+class BVHTraversalStats
+{
+public:
+    static inline void set_enabled(b32 _is_enabled);
+    static inline void add_node_visits(u64 _nb_visits);
+    static inline u64 get_nb_node_visits();
+    static inline void reset();
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<u64> nb_node_visits; // static storage, zero-initialized
+    };
+
+    static constexpr u32 k_nb_slots = 64u; // threads outside a pool share the last one
+
+    static inline std::atomic<b32> s_is_enabled = false;
+    static inline Slot s_slots[k_nb_slots];
+};
+
+// Per-level report of a SAH build. A level's time is the CPU time spent binning and
+// partitioning its nodes, summed over the threads that built them. LBVH builds only
+// report the total.
+struct BVHBuildStats
+{
+    struct Level
+    {
+        u32 nb_nodes = 0u;
+        u64 nb_primitives = 0u;
+        f64 seconds = 0.;
+    };
+
+    inline void print() const;
+
+    f64 seconds = 0.;
+    u32 nb_threads = 1u;
+    std::vector<Level> levels;
+};
+
+struct BVHCacheStats; // engine/bvhcache.h
+
+struct BVHSettings
+{
+    BVHBuilder builder = BVHBuilder::SAH;
+    BVHLayout layout   = BVHLayout::Flat; // read by create_bvh(), a BVH object is always the pointer tree
+    u32 max_leaf_size  = 4u;   // SAH: ranges up to this size stay unsplit when that is cheaper
+    u32 nb_bins        = 16u;  // SAH: candidate split planes per axis
+    f32 traversal_cost = 1.f;  // SAH: cost of visiting a node, relative to one primitive test
+    BVHTraversal traversal = BVHTraversal::Ordered; // pointer and flat layouts, wide nodes always go nearest first
+
+    // Motion layout: nested halvings of the time range allowed on a path, taken by nodes whose
+    // box over the interval is this much larger (area) than the one interpolated halfway
+    u32 max_time_splits = 0u;
+    f32 time_split_ratio = 1.5f;
+
+    // SAH and LBVH parallel build, the tree is the same as the serial one
+    ThreadPool* pool = nullptr;
+    u32 parallel_binning_size = 1u << 16u; // ranges this large bin in chunks on the pool
+    u32 task_size = 4096u;                 // ranges this large build their children as separate jobs (LBVH: passes over this many run in chunks)
+    BVHBuildStats* build_stats = nullptr;  // filled when set
+
+    // create_bvh(), flat layout: the flattened tree is stored in this directory under a hash of
+    // the primitives' bounds and these settings, later builds map it back instead
+    std::string cache_dir;
+    BVHCacheStats* cache_stats = nullptr; // filled when set
+
+    // create_bvh(): unbounded primitives and those whose box has over this many times the area of
+    // the box around the smaller ones stay out of the tree, in an OutlierBVH list (0: only the unbounded)
+    f32 outlier_area_ratio = 16.f;
+
+    // DynamicBVH: refits while the SAH cost of a subtree stays within this factor of its cost
+    // when it was built, past it the subtree is rebuilt
+    f32 rebuild_ratio = 1.3f;
+};
+
+// Primitives of one SAH leaf, tested in sequence like a HitableList but not owning them
+class BVHLeaf : public Hitable
+{
+public:
+    inline BVHLeaf(std::vector<Hitable*>&& _hitables, const AABB& _aabb);
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    // Bounds of the primitives' current positions
+    inline void refit(f32 _t0, f32 _t1);
+
+    inline u32 get_size() const;
+    inline const std::vector<Hitable*>& get_hitables() const;
+
+private:
+    std::vector<Hitable*> m_hitables;
+    AABB m_aabb;
+};
+
 class BVH : public Hitable
 {
 public:
     constexpr BVH() = default;
-    inline explicit BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1);
+    inline explicit BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {});
     constexpr BVH(const BVH&) noexcept = delete;
     constexpr BVH& operator=(const BVH&) noexcept = delete;
     inline BVH(BVH&& _other) noexcept;
@@ -14,17 +216,93 @@ public:
     virtual inline ~BVH();
 
     inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline b32 hit_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_, u32* nb_visits_) const override;
+    inline b32 occluded_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, u32* nb_visits_) const override;
     inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
     inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
 
+    // Expected cost of a random ray hitting the root: node visits weighted by traversal
+    // cost plus primitive tests, each scaled by the probability (area ratio) of reaching it
+    inline f32 get_sah_cost(f32 _traversal_cost = BVHSettings {}.traversal_cost) const;
+
+    // Recomputes every node's bounds bottom-up after primitives moved, the tree keeps its shape
+    inline void refit(f32 _t0, f32 _t1);
+
+    // Bounds of any child after refitting it, and the primitives below it
+    static inline void refit(Hitable* _hitable, f32 _t0, f32 _t1, AABB* aabb_);
+    static inline void collect_primitives(const Hitable* _hitable, std::vector<Hitable*>* primitives_);
+
+    // SAH cost of the subtree below a child before dividing by any area, what get_sah_cost() sums up
+    static inline f64 accumulate_sah_cost(const Hitable* _hitable, f32 _traversal_cost);
+
 public:
     Hitable* left  = nullptr;
     Hitable* right = nullptr;
     AABB aabb      = {};
+    u8 split_axis  = 0u; // left holds the lower side along this axis
+    BVHTraversal traversal = BVHTraversal::Ordered;
 
 private:
+    struct BuildPrimitive
+    {
+        AABB bounds;
+        fv3 centroid;
+        Hitable* hitable;
+    };
+
+    struct SahSplit
+    {
+        u32 axis  = 0u;
+        u32 bin   = 0u; // primitives in bins [0, bin] go left
+        f32 cost  = std::numeric_limits<f32>::max();
+        AABB centroid_bounds;
+    };
+
+    // State shared by every node of one SAH build, possibly from several threads
+    struct SahBuild
+    {
+        inline explicit SahBuild(const BVHSettings& _settings);
+
+        inline void add_node(u32 _depth, u32 _nb_primitives, std::chrono::high_resolution_clock::time_point _start);
+        inline void write_stats() const;
+
+        static constexpr u32 k_max_levels = 64u; // deeper nodes are counted in the last level
+
+        struct Level
+        {
+            std::atomic<u32> nb_nodes = 0u;
+            std::atomic<u64> nb_primitives = 0u;
+            std::atomic<u64> ns = 0u;
+        };
+
+        const BVHSettings& settings;
+        const u32 nb_bins;
+        const std::chrono::high_resolution_clock::time_point start;
+        Level levels[k_max_levels];
+    };
+
+    inline void build(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, Rng& _rng);
+    inline void build_lbvh(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings);
+    inline void build_sah(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings);
+
+    inline void build_sah(BuildPrimitive* _primitives, u32 _nb_primitives, const AABB& _bounds, SahBuild& _build, u32 _depth);
+    static inline Hitable* create_sah_child(BuildPrimitive* _primitives, u32 _nb_primitives, SahBuild& _build, u32 _depth);
+    static inline SahSplit find_sah_split(const BuildPrimitive* _primitives, u32 _nb_primitives, const AABB& _bounds, const SahBuild& _build);
+    static inline u32 partition_sah(BuildPrimitive* _primitives, u32 _nb_primitives, const SahSplit& _split, const SahBuild& _build);
+    static inline u32 get_sah_bin(const fv3& _centroid, const SahSplit& _split, u32 _nb_bins);
+
+    template <typename T, typename Fn, typename MergeFn>
+    static inline T reduce_chunks(const SahBuild& _build, u32 _count, Fn&& _fn, MergeFn&& _merge);
+    static inline void merge_bounds(AABB& bounds_, const AABB& _bounds);
+
+    static inline void set_traversal(Hitable* _hitable, BVHTraversal _traversal);
+
+    static constexpr u64 k_split_seed = 0xb5297a4d3f84d5b5ull;
+
     enum class BVHAxis { X, Y, Z };
-    
+
     template <BVHAxis _axis>
     struct BoxCmp
     {
@@ -32,9 +310,278 @@ private:
     };
 };
 
-inline BVH::BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1)
+// BVHLeaf //
+
+inline BVHLeaf::BVHLeaf(std::vector<Hitable*>&& _hitables, const AABB& _aabb)
+    : m_hitables(std::move(_hitables))
+    , m_aabb(_aabb)
+{
+}
+
+inline b32 BVHLeaf::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    b32 has_hit_anything = false;
+    f32 closest_dist = _zmax;
+    for (const Hitable* hitable : m_hitables)
+    {
+        Hit tmp_hit;
+        if (hitable->hit(_ray, _time, _zmin, closest_dist, &tmp_hit))
+        {
+            has_hit_anything = true;
+            closest_dist = tmp_hit.distance;
+            *hit_ = std::move(tmp_hit);
+        }
+    }
+    return has_hit_anything;
+}
+
+inline b32 BVHLeaf::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    for (const Hitable* hitable : m_hitables)
+    {
+        if (hitable->occluded(_ray, _time, _zmin, _zmax))
+            return true;
+    }
+    return false;
+}
+
+inline b32 BVHLeaf::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    *aabb_ = m_aabb;
+    return true;
+}
+
+inline b32 BVHLeaf::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    *aabb_ = m_aabb;
+    return true;
+}
+
+inline void BVHLeaf::refit(f32 _t0, f32 _t1)
+{
+    for (u32 idx = 0u; idx < m_hitables.size(); ++idx)
+    {
+        AABB bounds;
+        m_hitables[idx]->compute_aabb(_t0, _t1, &bounds);
+        m_aabb = (idx == 0u) ? bounds : AABB::get_surrounding_box(m_aabb, bounds);
+    }
+}
+
+inline u32 BVHLeaf::get_size() const
+{
+    return u32(m_hitables.size());
+}
+
+inline const std::vector<Hitable*>& BVHLeaf::get_hitables() const
+{
+    return m_hitables;
+}
+
+// BVH //
+
+inline BVH::BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+{
+    if (_settings.builder == BVHBuilder::Median)
+    {
+        // Split axes come from a fixed stream, the same scene always builds the same tree
+        Rng rng(k_split_seed);
+        build(_hitables, _nb_hitables, _t0, _t1, rng);
+    }
+    else if (_settings.builder == BVHBuilder::LBVH)
+    {
+        build_lbvh(_hitables, _nb_hitables, _t0, _t1, _settings);
+    }
+    else
+    {
+        build_sah(_hitables, _nb_hitables, _t0, _t1, _settings);
+    }
+
+    // Nodes are created ordered
+    if (_settings.traversal != BVHTraversal::Ordered)
+        set_traversal(this, _settings.traversal);
+}
+
+inline void BVH::build_sah(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+{
+    if (_nb_hitables == 0u)
+        return;
+
+    // Bounds are queried once up front, the binning passes only read this array
+    SahBuild sah_build(_settings);
+    std::vector<BuildPrimitive> primitives(_nb_hitables);
+    const AABB bounds = reduce_chunks<AABB>(sah_build, _nb_hitables, [&](u32 _begin, u32 _end)
+    {
+        AABB chunk_bounds;
+        for (u32 idx = _begin; idx < _end; ++idx)
+        {
+            BuildPrimitive& primitive = primitives[idx];
+            if (!_hitables[idx]->compute_aabb(_t0, _t1, &primitive.bounds))
+                util::output_to_console("No bounding box in BVH constructor.");
+            primitive.centroid = primitive.bounds.get_center();
+            primitive.hitable = _hitables[idx];
+            chunk_bounds = (idx == _begin) ? primitive.bounds : AABB::get_surrounding_box(chunk_bounds, primitive.bounds);
+        }
+        return chunk_bounds;
+    }, merge_bounds);
+    build_sah(primitives.data(), _nb_hitables, bounds, sah_build, 0u);
+    sah_build.write_stats();
+}
+
+inline void BVH::build_lbvh(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
 {
-    const BVHAxis axis = BVHAxis(u32(3u * util::drand_01()));
+    const auto start = std::chrono::high_resolution_clock::now();
+    ThreadPool* pool = (_settings.pool && _settings.pool->get_nb_threads() > 1u) ? _settings.pool : nullptr;
+    auto run_chunks = [pool, &_settings](u32 _count, const std::function<void(u32 _chunk, u32 _begin, u32 _end)>& _fn)
+    {
+        if (pool && _count >= _settings.task_size)
+            pool->parallel_for(_count, 2u * pool->get_nb_threads(), _fn);
+        else
+            _fn(0u, 0u, _count);
+    };
+
+    if (_nb_hitables == 0u)
+        return;
+
+    std::vector<AABB> bounds(_nb_hitables);
+    run_chunks(_nb_hitables, [&](u32, u32 _begin, u32 _end)
+    {
+        for (u32 idx = _begin; idx < _end; ++idx)
+        {
+            if (!_hitables[idx]->compute_aabb(_t0, _t1, &bounds[idx]))
+                util::output_to_console("No bounding box in BVH constructor.");
+        }
+    });
+
+    if (_nb_hitables == 1u)
+    {
+        left = right = _hitables[0];
+        aabb = bounds[0];
+        return;
+    }
+
+    // Centroids are quantized to a 1024^3 grid over their own bounds
+    AABB centroid_bounds(bounds[0].get_center(), bounds[0].get_center());
+    for (const AABB& box : bounds)
+        centroid_bounds = AABB::get_surrounding_box(centroid_bounds, AABB(box.get_center(), box.get_center()));
+    const fv3 extent = centroid_bounds.max - centroid_bounds.min;
+    const fv3 scale(extent.x > 0.f ? 1023.f / extent.x : 0.f, extent.y > 0.f ? 1023.f / extent.y : 0.f, extent.z > 0.f ? 1023.f / extent.z : 0.f);
+
+    // Key = code << 32 | index: keys are unique, equal codes keep their scene order
+    std::vector<u64> keys(_nb_hitables);
+    run_chunks(_nb_hitables, [&](u32, u32 _begin, u32 _end)
+    {
+        for (u32 idx = _begin; idx < _end; ++idx)
+        {
+            const fv3 cell = (bounds[idx].get_center() - centroid_bounds.min) * scale;
+            keys[idx] = (u64(math::morton_encode_3d(u32(cell.x), u32(cell.y), u32(cell.z))) << 32u) | idx;
+        }
+    });
+    util::radix_sort(&keys, 32u, 30u, pool);
+
+    // Karras 2012: internal node i covers the sorted range starting or ending at i that shares
+    // its longest key prefix, and splits it where the first differing bit flips. Every node
+    // is found independently of the others. Children with the leaf bit are primitives.
+    constexpr u32 k_leaf_bit = 1u << 31u;
+    const s64 nb_keys = s64(_nb_hitables);
+    auto get_prefix = [&keys, nb_keys](s64 _i, s64 _j) -> s32
+    {
+        return (_j < 0 || _j >= nb_keys) ? -1 : s32(std::countl_zero(keys[usize(_i)] ^ keys[usize(_j)]));
+    };
+
+    const u32 nb_internal = _nb_hitables - 1u;
+    std::vector<BVH*> nodes(nb_internal, nullptr);
+    std::vector<u32> children(2u * nb_internal);
+    std::vector<u32> parents(nb_internal + _nb_hitables, ~0u); // internal nodes, then leaves
+    nodes[0] = this;
+    run_chunks(nb_internal, [&](u32, u32 _begin, u32 _end)
+    {
+        for (u32 node = _begin; node < _end; ++node)
+        {
+            const s64 i = s64(node);
+            const s64 d = (get_prefix(i, i + 1) - get_prefix(i, i - 1) >= 0) ? 1 : -1;
+            const s32 min_prefix = get_prefix(i, i - d);
+
+            s64 max_length = 2;
+            while (get_prefix(i, i + max_length * d) > min_prefix)
+                max_length *= 2;
+            s64 length = 0;
+            for (s64 step = max_length / 2; step >= 1; step /= 2)
+            {
+                if (get_prefix(i, i + (length + step) * d) > min_prefix)
+                    length += step;
+            }
+            const s64 j = i + length * d;
+
+            const s32 node_prefix = get_prefix(i, j);
+            s64 split = 0;
+            for (s64 div = 2;; div *= 2)
+            {
+                const s64 step = (length + div - 1) / div;
+                if (get_prefix(i, i + (split + step) * d) > node_prefix)
+                    split += step;
+                if (step <= 1)
+                    break;
+            }
+            const u32 gamma = u32(i + split * d + math::min(d, s64(0)));
+
+            // The range splits on its first differing key bit; Morton bits cycle x, y, z from bit 32,
+            // below that only the index differs and any axis will do
+            const u32 split_bit = 63u - u32(node_prefix);
+            const u8 split_axis = (split_bit >= 32u) ? u8((split_bit - 32u) % 3u) : 0u;
+
+            const u32 first = u32(math::min(i, j));
+            const u32 last = u32(math::max(i, j));
+            children[2u * node]      = (first == gamma) ? (gamma | k_leaf_bit) : gamma;
+            children[2u * node + 1u] = (last == gamma + 1u) ? ((gamma + 1u) | k_leaf_bit) : (gamma + 1u);
+            for (u32 side = 0u; side < 2u; ++side)
+            {
+                const u32 child = children[2u * node + side];
+                parents[(child & k_leaf_bit) ? nb_internal + (child & ~k_leaf_bit) : child] = node;
+            }
+            if (node > 0u)
+                nodes[node] = new BVH();
+            nodes[node]->split_axis = split_axis;
+        }
+    });
+
+    // Bounds bottom-up: the second child to arrive at a node merges both and moves up
+    std::vector<std::atomic<u32>> nb_arrivals(nb_internal);
+    run_chunks(_nb_hitables, [&](u32, u32 _begin, u32 _end)
+    {
+        for (u32 leaf = _begin; leaf < _end; ++leaf)
+        {
+            u32 node = parents[nb_internal + leaf];
+            while (node != ~0u && nb_arrivals[node].fetch_add(1u, std::memory_order_acq_rel) == 1u)
+            {
+                BVH* bvh = nodes[node];
+                Hitable* child_nodes[2];
+                AABB child_bounds[2];
+                for (u32 side = 0u; side < 2u; ++side)
+                {
+                    const u32 child = children[2u * node + side];
+                    const u32 primitive = u32(keys[child & ~k_leaf_bit] & 0xffffffffu);
+                    child_nodes[side] = (child & k_leaf_bit) ? _hitables[primitive] : nodes[child];
+                    child_bounds[side] = (child & k_leaf_bit) ? bounds[primitive] : nodes[child]->aabb;
+                }
+                bvh->left = child_nodes[0];
+                bvh->right = child_nodes[1];
+                bvh->aabb = AABB::get_surrounding_box(child_bounds[0], child_bounds[1]);
+                node = parents[node];
+            }
+        }
+    });
+
+    if (BVHBuildStats* stats = _settings.build_stats)
+    {
+        stats->seconds = std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+        stats->nb_threads = pool ? pool->get_nb_threads() : 1u;
+        stats->levels.clear();
+    }
+}
+
+inline void BVH::build(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, Rng& _rng)
+{
+    const BVHAxis axis = BVHAxis(_rng.next_bounded(3u));
     switch (axis)
     {
         case BVHAxis::X: std::sort(_hitables, _hitables + _nb_hitables, BoxCmp<BVHAxis::X>()); break;
@@ -54,9 +601,14 @@ inline BVH::BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1)
     else
     {
         const u32 half_sz = _nb_hitables / 2u;
-        left  = new BVH(_hitables, half_sz, _t0, _t1);
-        right = new BVH(_hitables + half_sz, _nb_hitables - half_sz, _t0, _t1);
+        BVH* left_node  = new BVH();
+        BVH* right_node = new BVH();
+        left_node->build(_hitables, half_sz, _t0, _t1, _rng);
+        right_node->build(_hitables + half_sz, _nb_hitables - half_sz, _t0, _t1, _rng);
+        left  = left_node;
+        right = right_node;
     }
+    split_axis = u8(axis);
 
     AABB box_left, box_right;
     if (!left->compute_aabb(_t0, _t1, &box_left) ||
@@ -67,10 +619,365 @@ inline BVH::BVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1)
     aabb = AABB::get_surrounding_box(box_left, box_right);
 }
 
+inline void BVH::build_sah(BuildPrimitive* _primitives, u32 _nb_primitives, const AABB& _bounds, SahBuild& _build, u32 _depth)
+{
+    aabb = _bounds;
+    if (_nb_primitives == 1u)
+    {
+        left = right = _primitives[0].hitable;
+        return;
+    }
+
+    // A BVH node always has two children, the leaf decision is taken one level down
+    const auto start = std::chrono::high_resolution_clock::now();
+    const SahSplit split = find_sah_split(_primitives, _nb_primitives, _bounds, _build);
+    split_axis = u8(split.axis);
+    const u32 nb_left = partition_sah(_primitives, _nb_primitives, split, _build);
+    _build.add_node(_depth, _nb_primitives, start);
+
+    // Large ranges fork: the left child becomes a job, the right one is built here meanwhile
+    ThreadPool* pool = _build.settings.pool;
+    if (pool && _nb_primitives >= _build.settings.task_size)
+    {
+        std::atomic<u32> nb_remaining = 1u;
+        pool->submit([this, _primitives, nb_left, &_build, _depth, &nb_remaining]()
+        {
+            left = create_sah_child(_primitives, nb_left, _build, _depth + 1u);
+            nb_remaining.fetch_sub(1u, std::memory_order_release);
+        });
+        right = create_sah_child(_primitives + nb_left, _nb_primitives - nb_left, _build, _depth + 1u);
+        pool->wait_for(nb_remaining);
+    }
+    else
+    {
+        left  = create_sah_child(_primitives, nb_left, _build, _depth + 1u);
+        right = create_sah_child(_primitives + nb_left, _nb_primitives - nb_left, _build, _depth + 1u);
+    }
+}
+
+inline Hitable* BVH::create_sah_child(BuildPrimitive* _primitives, u32 _nb_primitives, SahBuild& _build, u32 _depth)
+{
+    if (_nb_primitives == 1u)
+        return _primitives[0].hitable;
+
+    const AABB bounds = reduce_chunks<AABB>(_build, _nb_primitives, [_primitives](u32 _begin, u32 _end)
+    {
+        AABB chunk_bounds = _primitives[_begin].bounds;
+        for (u32 idx = _begin + 1u; idx < _end; ++idx)
+            chunk_bounds = AABB::get_surrounding_box(chunk_bounds, _primitives[idx].bounds);
+        return chunk_bounds;
+    }, merge_bounds);
+
+    // Leaf cost is one test per primitive, split costs are in the same unit
+    const BVHSettings& settings = _build.settings;
+    if (_nb_primitives <= settings.max_leaf_size &&
+        f32(_nb_primitives) <= find_sah_split(_primitives, _nb_primitives, bounds, _build).cost)
+    {
+        std::vector<Hitable*> hitables(_nb_primitives);
+        for (u32 idx = 0u; idx < _nb_primitives; ++idx)
+            hitables[idx] = _primitives[idx].hitable;
+        return new BVHLeaf(std::move(hitables), bounds);
+    }
+
+    BVH* node = new BVH();
+    node->build_sah(_primitives, _nb_primitives, bounds, _build, _depth);
+    return node;
+}
+
+inline BVH::SahSplit BVH::find_sah_split(const BuildPrimitive* _primitives, u32 _nb_primitives, const AABB& _bounds, const SahBuild& _build)
+{
+    struct Bin
+    {
+        AABB bounds;
+        u32 count = 0u;
+
+        inline void add(const AABB& _bounds, u32 _count)
+        {
+            if (_count == 0u)
+                return;
+            bounds = (count == 0u) ? _bounds : AABB::get_surrounding_box(bounds, _bounds);
+            count += _count;
+        }
+    };
+
+    SahSplit best;
+    best.centroid_bounds = reduce_chunks<AABB>(_build, _nb_primitives, [_primitives](u32 _begin, u32 _end)
+    {
+        AABB chunk_bounds(_primitives[_begin].centroid, _primitives[_begin].centroid);
+        for (u32 idx = _begin + 1u; idx < _end; ++idx)
+            chunk_bounds = AABB::get_surrounding_box(chunk_bounds, AABB(_primitives[idx].centroid, _primitives[idx].centroid));
+        return chunk_bounds;
+    }, merge_bounds);
+
+    // All three axes are binned in one pass over the primitives; min/max and counts merge
+    // exactly, the bins do not depend on how the range was chunked
+    const u32 nb_bins = _build.nb_bins;
+    const std::vector<Bin> bins = reduce_chunks<std::vector<Bin>>(_build, _nb_primitives, [&](u32 _begin, u32 _end)
+    {
+        std::vector<Bin> chunk_bins(3u * nb_bins);
+        for (u32 axis = 0u; axis < 3u; ++axis)
+        {
+            if (best.centroid_bounds.max[axis] <= best.centroid_bounds.min[axis])
+                continue;
+            SahSplit candidate = best;
+            candidate.axis = axis;
+            for (u32 idx = _begin; idx < _end; ++idx)
+                chunk_bins[axis * nb_bins + get_sah_bin(_primitives[idx].centroid, candidate, nb_bins)].add(_primitives[idx].bounds, 1u);
+        }
+        return chunk_bins;
+    }, [](std::vector<Bin>& bins_, const std::vector<Bin>& _chunk_bins)
+    {
+        for (usize bin = 0u; bin < bins_.size(); ++bin)
+            bins_[bin].add(_chunk_bins[bin].bounds, _chunk_bins[bin].count);
+    });
+
+    const f32 inv_area = math::inv(math::max(_bounds.get_surface_area(), std::numeric_limits<f32>::min()));
+    std::vector<f32> right_areas(nb_bins);
+    std::vector<u32> right_counts(nb_bins);
+    for (u32 axis = 0u; axis < 3u; ++axis)
+    {
+        // All centroids on one plane: no split along this axis separates anything
+        if (best.centroid_bounds.max[axis] <= best.centroid_bounds.min[axis])
+            continue;
+
+        const Bin* axis_bins = &bins[axis * nb_bins];
+
+        // Right-to-left sweep stores the area and count right of each plane, left-to-right evaluates
+        AABB sweep;
+        u32 count = 0u;
+        for (u32 bin = nb_bins - 1u; bin > 0u; --bin)
+        {
+            if (axis_bins[bin].count > 0u)
+                sweep = (count == 0u) ? axis_bins[bin].bounds : AABB::get_surrounding_box(sweep, axis_bins[bin].bounds);
+            count += axis_bins[bin].count;
+            right_areas[bin] = (count > 0u) ? sweep.get_surface_area() : 0.f;
+            right_counts[bin] = count;
+        }
+
+        count = 0u;
+        for (u32 bin = 0u; bin + 1u < nb_bins; ++bin)
+        {
+            if (axis_bins[bin].count > 0u)
+                sweep = (count == 0u) ? axis_bins[bin].bounds : AABB::get_surrounding_box(sweep, axis_bins[bin].bounds);
+            count += axis_bins[bin].count;
+            if (count == 0u || right_counts[bin + 1u] == 0u)
+                continue;
+
+            const f32 cost = _build.settings.traversal_cost +
+                             (sweep.get_surface_area() * f32(count) + right_areas[bin + 1u] * f32(right_counts[bin + 1u])) * inv_area;
+            if (cost < best.cost)
+            {
+                best.axis = axis;
+                best.bin = bin;
+                best.cost = cost;
+            }
+        }
+    }
+    return best;
+}
+
+inline u32 BVH::partition_sah(BuildPrimitive* _primitives, u32 _nb_primitives, const SahSplit& _split, const SahBuild& _build)
+{
+    // Coincident centroids (no valid plane): halve the range, order does not matter
+    if (_split.cost == std::numeric_limits<f32>::max())
+        return _nb_primitives / 2u;
+
+    const BuildPrimitive* middle = std::partition(_primitives, _primitives + _nb_primitives, [&](const BuildPrimitive& _primitive)
+    {
+        return get_sah_bin(_primitive.centroid, _split, _build.nb_bins) <= _split.bin;
+    });
+    return u32(middle - _primitives);
+}
+
+inline u32 BVH::get_sah_bin(const fv3& _centroid, const SahSplit& _split, u32 _nb_bins)
+{
+    const f32 min = _split.centroid_bounds.min[_split.axis];
+    const f32 extent = _split.centroid_bounds.max[_split.axis] - min;
+    return math::min(u32(f32(_nb_bins) * (_centroid[_split.axis] - min) / extent), _nb_bins - 1u);
+}
+
+template <typename T, typename Fn, typename MergeFn>
+inline T BVH::reduce_chunks(const SahBuild& _build, u32 _count, Fn&& _fn, MergeFn&& _merge)
+{
+    // _fn(begin, end) reduces one chunk; the chunk results are merged in chunk order
+    // afterwards, whatever order the chunks finished in
+    ThreadPool* pool = _build.settings.pool;
+    if (!pool || pool->get_nb_threads() < 2u || _count < _build.settings.parallel_binning_size)
+        return _fn(0u, _count);
+
+    const u32 nb_chunks = math::min(2u * pool->get_nb_threads(), _count);
+    std::vector<T> results(nb_chunks);
+    pool->parallel_for(_count, nb_chunks, [&](u32 _chunk, u32 _begin, u32 _end) { results[_chunk] = _fn(_begin, _end); });
+
+    T result = std::move(results[0]);
+    for (u32 chunk = 1u; chunk < nb_chunks; ++chunk)
+        _merge(result, results[chunk]);
+    return result;
+}
+
+inline void BVH::merge_bounds(AABB& bounds_, const AABB& _bounds)
+{
+    bounds_ = AABB::get_surrounding_box(bounds_, _bounds);
+}
+
+// BVH::SahBuild //
+
+inline BVH::SahBuild::SahBuild(const BVHSettings& _settings)
+    : settings(_settings)
+    , nb_bins(math::max(_settings.nb_bins, 2u))
+    , start(std::chrono::high_resolution_clock::now())
+{
+}
+
+inline void BVH::SahBuild::add_node(u32 _depth, u32 _nb_primitives, std::chrono::high_resolution_clock::time_point _start)
+{
+    if (!settings.build_stats)
+        return;
+
+    const u64 ns = u64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - _start).count());
+    Level& level = levels[math::min(_depth, k_max_levels - 1u)];
+    level.nb_nodes.fetch_add(1u, std::memory_order_relaxed);
+    level.nb_primitives.fetch_add(_nb_primitives, std::memory_order_relaxed);
+    level.ns.fetch_add(ns, std::memory_order_relaxed);
+}
+
+inline void BVH::SahBuild::write_stats() const
+{
+    BVHBuildStats* stats = settings.build_stats;
+    if (!stats)
+        return;
+
+    stats->seconds = std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+    stats->nb_threads = settings.pool ? settings.pool->get_nb_threads() : 1u;
+    stats->levels.clear();
+    for (const Level& level : levels)
+    {
+        if (level.nb_nodes.load(std::memory_order_relaxed) == 0u)
+            break;
+        stats->levels.push_back({ level.nb_nodes.load(std::memory_order_relaxed), level.nb_primitives.load(std::memory_order_relaxed),
+                                  f64(level.ns.load(std::memory_order_relaxed)) * 1e-9 });
+    }
+}
+
+// BVHTraversalStats //
+
+inline void BVHTraversalStats::set_enabled(b32 _is_enabled)
+{
+    s_is_enabled.store(_is_enabled, std::memory_order_relaxed);
+}
+
+inline void BVHTraversalStats::add_node_visits(u64 _nb_visits)
+{
+    if (!s_is_enabled.load(std::memory_order_relaxed))
+        return;
+    const u32 worker = ThreadPool::get_worker_index();
+    Slot& slot = s_slots[(worker != ThreadPool::k_invalid_worker) ? worker % (k_nb_slots - 1u) : k_nb_slots - 1u];
+    slot.nb_node_visits.fetch_add(_nb_visits, std::memory_order_relaxed);
+}
+
+inline u64 BVHTraversalStats::get_nb_node_visits()
+{
+    u64 nb_visits = 0u;
+    for (const Slot& slot : s_slots)
+        nb_visits += slot.nb_node_visits.load(std::memory_order_relaxed);
+    return nb_visits;
+}
+
+inline void BVHTraversalStats::reset()
+{
+    for (Slot& slot : s_slots)
+        slot.nb_node_visits.store(0u, std::memory_order_relaxed);
+}
+
+// BVHBuildStats //
+
+inline void BVHBuildStats::print() const
+{
+    util::output_to_console("BVH build %.3fs on %u threads, %zu levels", seconds, nb_threads, levels.size());
+    util::output_to_console("  %5s %9s %12s %10s", "level", "nodes", "primitives", "cpu ms");
+    for (usize idx = 0u; idx < levels.size(); ++idx)
+        util::output_to_console("  %5zu %9u %12llu %10.3f", idx, levels[idx].nb_nodes, levels[idx].nb_primitives, levels[idx].seconds * 1e3);
+}
+
+// BVH //
+
+inline f32 BVH::get_sah_cost(f32 _traversal_cost) const
+{
+    const f32 area = aabb.get_surface_area();
+    return (area > 0.f) ? f32(accumulate_sah_cost(this, _traversal_cost) / area) : 0.f;
+}
+
+inline void BVH::refit(f32 _t0, f32 _t1)
+{
+    AABB box_left, box_right;
+    refit(left, _t0, _t1, &box_left);
+    if (right != left)
+        refit(right, _t0, _t1, &box_right);
+    else
+        box_right = box_left;
+    aabb = AABB::get_surrounding_box(box_left, box_right);
+}
+
+inline void BVH::refit(Hitable* _hitable, f32 _t0, f32 _t1, AABB* aabb_)
+{
+    if (BVH* node = dynamic_cast<BVH*>(_hitable))
+    {
+        node->refit(_t0, _t1);
+        *aabb_ = node->aabb;
+        return;
+    }
+    if (BVHLeaf* leaf = dynamic_cast<BVHLeaf*>(_hitable))
+        leaf->refit(_t0, _t1);
+    _hitable->compute_aabb(_t0, _t1, aabb_);
+}
+
+inline void BVH::collect_primitives(const Hitable* _hitable, std::vector<Hitable*>* primitives_)
+{
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        collect_primitives(node->left, primitives_);
+        if (node->right != node->left)
+            collect_primitives(node->right, primitives_);
+    }
+    else if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+        primitives_->insert(primitives_->end(), leaf->get_hitables().begin(), leaf->get_hitables().end());
+    else
+        primitives_->push_back(const_cast<Hitable*>(_hitable));
+}
+
+inline void BVH::set_traversal(Hitable* _hitable, BVHTraversal _traversal)
+{
+    if (BVH* node = dynamic_cast<BVH*>(_hitable))
+    {
+        node->traversal = _traversal;
+        set_traversal(node->left, _traversal);
+        if (node->right != node->left)
+            set_traversal(node->right, _traversal);
+    }
+}
+
+inline f64 BVH::accumulate_sah_cost(const Hitable* _hitable, f32 _traversal_cost)
+{
+    AABB bounds;
+    _hitable->compute_aabb(0.f, 1.f, &bounds);
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        f64 cost = _traversal_cost * node->aabb.get_surface_area() + accumulate_sah_cost(node->left, _traversal_cost);
+        if (node->right != node->left)
+            cost += accumulate_sah_cost(node->right, _traversal_cost);
+        return cost;
+    }
+    if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+        return f32(leaf->get_size()) * bounds.get_surface_area();
+    return bounds.get_surface_area();
+}
+
 inline BVH::BVH(BVH&& _other) noexcept
     : left(std::exchange(_other.left, nullptr))
     , right(std::exchange(_other.right, nullptr))
     , aabb(std::move(_other.aabb))
+    , split_axis(_other.split_axis)
+    , traversal(_other.traversal)
 {
 }
 
@@ -81,6 +988,8 @@ inline constexpr BVH& BVH::operator=(BVH&& _other) noexcept
         left  = std::exchange(_other.left, nullptr);
         right = std::exchange(_other.right, nullptr);
         aabb  = std::move(_other.aabb);
+        split_axis = _other.split_axis;
+        traversal = _other.traversal;
     }
     return *this;
 }
@@ -89,18 +998,59 @@ inline BVH::~BVH()
 {
     if (BVH* l = dynamic_cast<BVH*>(left))
         util::safe_del(l);
+    else if (BVHLeaf* l = dynamic_cast<BVHLeaf*>(left))
+        util::safe_del(l);
 
     if (BVH* r = dynamic_cast<BVH*>(right))
         util::safe_del(r);
+    else if (BVHLeaf* r = dynamic_cast<BVHLeaf*>(right))
+        util::safe_del(r);
 }
 
 inline b32 BVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
 {
-    if (aabb.is_hit(_ray, _zmin, _zmax))
+    u32 nb_visits = 0u;
+    const b32 has_hit = hit_subtree(_ray, _time, _zmin, _zmax, hit_, &nb_visits);
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return has_hit;
+}
+
+inline b32 BVH::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    u32 nb_visits = 0u;
+    const b32 is_occluded = occluded_subtree(_ray, _time, _zmin, _zmax, &nb_visits);
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return is_occluded;
+}
+
+inline b32 BVH::hit_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_, u32* nb_visits_) const
+{
+    ++*nb_visits_;
+    if (!aabb.is_hit(_ray, _zmin, _zmax))
+        return false;
+
+    if (traversal == BVHTraversal::Ordered)
+    {
+        // Near side first; its hit shrinks the range, so the far child's box test culls it
+        // whenever it starts beyond that hit
+        const b32 is_right_near = _ray.sign[split_axis];
+        const Hitable* near_child = is_right_near ? right : left;
+        const Hitable* far_child = is_right_near ? left : right;
+        const b32 is_hit_near = near_child->hit_subtree(_ray, _time, _zmin, _zmax, hit_, nb_visits_);
+
+        Hit far_hit;
+        if (far_child != near_child && far_child->hit_subtree(_ray, _time, _zmin, is_hit_near ? hit_->distance : _zmax, &far_hit, nb_visits_))
+        {
+            *hit_ = std::move(far_hit);
+            return true;
+        }
+        return is_hit_near;
+    }
+
     {
         Hit left_hit, right_hit;
-        const b32 is_hit_left  = left->hit(_ray, _time, _zmin, _zmax, &left_hit);
-        const b32 is_hit_right = right->hit(_ray, _time, _zmin, _zmax, &right_hit);
+        const b32 is_hit_left  = left->hit_subtree(_ray, _time, _zmin, _zmax, &left_hit, nb_visits_);
+        const b32 is_hit_right = right->hit_subtree(_ray, _time, _zmin, _zmax, &right_hit, nb_visits_);
         if (is_hit_left && is_hit_right)
         {
             *hit_ = std::move((left_hit.distance < right_hit.distance) ? left_hit : right_hit);
@@ -120,6 +1070,16 @@ inline b32 BVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_)
     return false;
 }
 
+inline b32 BVH::occluded_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, u32* nb_visits_) const
+{
+    // Any hit ends the query, so there is no range to shrink and no order to follow
+    ++*nb_visits_;
+    if (!aabb.is_hit(_ray, _zmin, _zmax))
+        return false;
+    return left->occluded_subtree(_ray, _time, _zmin, _zmax, nb_visits_) ||
+           (right != left && right->occluded_subtree(_ray, _time, _zmin, _zmax, nb_visits_));
+}
+
 inline b32 BVH::compute_aabb(f32 _time, AABB* aabb_) const
 {
     *aabb_ = aabb;
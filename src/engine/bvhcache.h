@@ -0,0 +1,307 @@
+// ======================================================================
+// File: bvhcache.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/mappedfile.h"
+#include "core/rng.h"
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/bvh.h"
+#include "engine/hitable.h"
+#include "engine/linearbvh.h"
+#include "engine/sphere.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// What create() did: mapped a stored tree, or built one and stored it
+struct BVHCacheStats
+{
+    inline void print() const;
+
+    b32 is_hit = false;
+    b32 is_stored = false;
+    std::filesystem::path path;
+    u64 file_size = 0u;
+    f64 key_seconds = 0.;   // hashing the primitives' bounds
+    f64 load_seconds = 0.;  // mapping the file and resolving the leaf primitives
+    f64 build_seconds = 0.;
+    f64 store_seconds = 0.;
+};
+
+// On-disk cache of flattened BVHs. A file holds a header, the LinearBVH node and packed sphere
+// arrays as they are and one index per leaf slot into the primitive array the tree was built
+// over. Loading maps the file and traces the nodes and spheres from the mapped pages; only the
+// leaf slots are turned back into pointers, the one part of the tree that cannot be stored. The file name is the key: a hash
+// of every primitive's bounds and of every sphere's packed geometry, the build settings, the
+// format version and the node size, so a changed scene or setting simply misses.
+namespace bvhcache
+{
+    constexpr u32 k_magic = 0x48564253u; // "SBVH"
+    constexpr u32 k_version = 3u; // 2: packed sphere leaves, 3: spheres of packed leaves only
+    constexpr u64 k_alignment = 64u; // of the node array in the file, mapped files are page aligned
+
+    struct Header
+    {
+        u32 magic;
+        u32 version;
+        u64 key;
+        u32 node_size;
+        u32 nb_nodes;
+        u32 nb_primitives; // leaf slots
+        u32 nb_spheres;    // slots of the packed leaves, the first ones
+        u32 depth;
+        u32 traversal;
+        u32 nb_hitables;   // of the array the indices point into
+        u32 padding;       // zero, keeps the offsets below 8-byte aligned
+        u64 nodes_offset;
+        u64 spheres_offset;
+        u64 indices_offset;
+    };
+
+    inline u64 hash_value(u64 _hash, u64 _value)
+    {
+        return Rng::mix(_hash ^ Rng::mix(_value + 0x9e3779b97f4a7c15ull));
+    }
+
+    inline u64 hash_value(u64 _hash, f32 _value)
+    {
+        u32 bits;
+        std::memcpy(&bits, &_value, sizeof(bits));
+        return hash_value(_hash, u64(bits));
+    }
+
+    inline u64 compute_key(Hitable* const* _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+    {
+        u64 key = hash_value(u64(k_magic), u64(k_version));
+        key = hash_value(key, u64(sizeof(LinearBVH::Node)));
+        key = hash_value(key, u64(sizeof(PackedSphere)));
+        key = hash_value(key, u64(_settings.builder));
+        key = hash_value(key, u64(_settings.max_leaf_size));
+        key = hash_value(key, u64(_settings.nb_bins));
+        key = hash_value(key, _settings.traversal_cost);
+        key = hash_value(key, u64(_settings.traversal));
+        key = hash_value(key, _t0);
+        key = hash_value(key, _t1);
+        key = hash_value(key, u64(_nb_hitables));
+        for (u32 idx = 0u; idx < _nb_hitables; ++idx)
+        {
+            AABB bounds;
+            _hitables[idx]->compute_aabb(_t0, _t1, &bounds);
+            const f32 values[6] = { bounds.min.x, bounds.min.y, bounds.min.z, bounds.max.x, bounds.max.y, bounds.max.z };
+            for (const f32 value : values)
+                key = hash_value(key, value);
+
+            // The file stores the spheres' geometry, bounds alone would not tell two swapped apart
+            if (const Sphere* sphere = dynamic_cast<const Sphere*>(_hitables[idx]))
+            {
+                const PackedSphere packed = sphere->get_packed();
+                const f32 geometry[8] = { packed.center.x, packed.center.y, packed.center.z, packed.sqr_radius,
+                                          packed.motion.x, packed.motion.y, packed.motion.z, packed.radius };
+                for (const f32 value : geometry)
+                    key = hash_value(key, value);
+            }
+        }
+        return key;
+    }
+
+    inline std::filesystem::path get_path(const std::filesystem::path& _dir, u64 _key)
+    {
+        utf8 name[32];
+        snprintf(name, sizeof(name), "%016llx.bvh", static_cast<unsigned long long>(_key));
+        return _dir / name;
+    }
+
+    // One pass over the stored nodes: every child link points forward inside the node array and
+    // every leaf range inside the leaf slots, so a damaged file cannot send traversal out of
+    // either. Children come after their parent, so each node's level is known before its
+    // children are reached; the deepest one must be the stored depth the stacks are sized by
+    inline b32 validate(const LinearBVH::Node* _nodes, u32 _nb_nodes, u32 _nb_primitives, u32 _nb_spheres, u32 _depth)
+    {
+        std::vector<u32> levels(_nb_nodes, 0u);
+        levels[0] = 1u;
+        u32 depth = 0u;
+        for (u32 idx = 0u; idx < _nb_nodes; ++idx)
+        {
+            const LinearBVH::Node& node = _nodes[idx];
+            depth = math::max(depth, levels[idx]);
+            if (node.nb_primitives > 0u)
+            {
+                if (u64(node.offset) + node.nb_primitives > (node.is_packed ? _nb_spheres : _nb_primitives))
+                    return false;
+                continue;
+            }
+            if (idx + 1u >= _nb_nodes || node.offset <= idx + 1u || node.offset >= _nb_nodes)
+                return false;
+            levels[idx + 1u] = math::max(levels[idx + 1u], levels[idx] + 1u);
+            levels[node.offset] = math::max(levels[node.offset], levels[idx] + 1u);
+        }
+        return depth == _depth;
+    }
+
+    // Indices refer to _hitables, the array the tree was built over in its original order
+    inline b32 store(const std::filesystem::path& _path, u64 _key, const LinearBVH& _bvh, Hitable* const* _hitables, u32 _nb_hitables)
+    {
+        std::unordered_map<const Hitable*, u32> hitable_indices;
+        hitable_indices.reserve(_nb_hitables);
+        for (u32 idx = 0u; idx < _nb_hitables; ++idx)
+            hitable_indices.emplace(_hitables[idx], idx);
+
+        const std::vector<Hitable*>& primitives = _bvh.get_primitives();
+        std::vector<u32> indices(primitives.size());
+        for (usize slot = 0u; slot < primitives.size(); ++slot)
+        {
+            const auto it = hitable_indices.find(primitives[slot]);
+            if (it == hitable_indices.end())
+                return false;
+            indices[slot] = it->second;
+        }
+
+        Header header = {};
+        header.magic = k_magic;
+        header.version = k_version;
+        header.key = _key;
+        header.node_size = u32(sizeof(LinearBVH::Node));
+        header.nb_nodes = _bvh.get_nb_nodes();
+        header.nb_primitives = u32(indices.size());
+        header.nb_spheres = _bvh.get_nb_spheres();
+        header.depth = _bvh.get_depth();
+        header.traversal = u32(_bvh.get_traversal());
+        header.nb_hitables = _nb_hitables;
+        header.nodes_offset = (sizeof(Header) + k_alignment - 1u) / k_alignment * k_alignment;
+        header.spheres_offset = header.nodes_offset + u64(header.nb_nodes) * sizeof(LinearBVH::Node);
+        header.indices_offset = header.spheres_offset + u64(header.nb_spheres) * sizeof(PackedSphere);
+
+        // Written aside and renamed, a reader never maps a half-written file
+        std::error_code error;
+        std::filesystem::create_directories(_path.parent_path(), error);
+        const std::filesystem::path tmp_path = _path.string() + ".tmp";
+        b32 is_written = false;
+        {
+            std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+            const utf8 padding[k_alignment] = {};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(padding, std::streamsize(header.nodes_offset - sizeof(header)));
+            file.write(reinterpret_cast<const char*>(_bvh.get_nodes()), std::streamsize(u64(header.nb_nodes) * sizeof(LinearBVH::Node)));
+            file.write(reinterpret_cast<const char*>(_bvh.get_spheres()), std::streamsize(u64(header.nb_spheres) * sizeof(PackedSphere)));
+            file.write(reinterpret_cast<const char*>(indices.data()), std::streamsize(indices.size() * sizeof(u32)));
+            file.close();
+            is_written = !file.fail();
+        }
+        if (is_written)
+            std::filesystem::rename(tmp_path, _path, error);
+        if (!is_written || error)
+        {
+            std::filesystem::remove(tmp_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    // nullptr when the file is missing or does not hold this key's tree
+    inline LinearBVH* load(const std::filesystem::path& _path, u64 _key, Hitable* const* _hitables, u32 _nb_hitables)
+    {
+        MappedFile mapping;
+        if (!mapping.open(_path) || mapping.get_size() < sizeof(Header))
+            return nullptr;
+
+        Header header;
+        std::memcpy(&header, mapping.get_data(), sizeof(header));
+        const u64 nodes_size = u64(header.nb_nodes) * sizeof(LinearBVH::Node);
+        const u64 spheres_size = u64(header.nb_spheres) * sizeof(PackedSphere);
+        const u64 indices_size = u64(header.nb_primitives) * sizeof(u32);
+        if (header.magic != k_magic || header.version != k_version || header.key != _key ||
+            header.node_size != sizeof(LinearBVH::Node) || header.nb_hitables != _nb_hitables || header.nb_nodes == 0u ||
+            header.nb_spheres > header.nb_primitives ||
+            header.nodes_offset % k_alignment != 0u || header.nodes_offset > header.spheres_offset ||
+            header.spheres_offset > header.indices_offset || header.indices_offset > mapping.get_size() ||
+            header.nodes_offset + nodes_size > header.spheres_offset || header.spheres_offset % alignof(PackedSphere) != 0u ||
+            header.spheres_offset + spheres_size > header.indices_offset || header.indices_offset + indices_size > mapping.get_size())
+        {
+            return nullptr;
+        }
+
+        std::vector<Hitable*> primitives(header.nb_primitives);
+        const u8* indices = mapping.get_data() + header.indices_offset;
+        for (u32 slot = 0u; slot < header.nb_primitives; ++slot)
+        {
+            u32 idx;
+            std::memcpy(&idx, indices + slot * sizeof(u32), sizeof(idx));
+            // Packed leaves are traced as spheres, whatever the slot says
+            if (idx >= _nb_hitables || (slot < header.nb_spheres && !dynamic_cast<const Sphere*>(_hitables[idx])))
+                return nullptr;
+            primitives[slot] = _hitables[idx];
+        }
+
+        const LinearBVH::Node* nodes = reinterpret_cast<const LinearBVH::Node*>(mapping.get_data() + header.nodes_offset);
+        if (!validate(nodes, header.nb_nodes, header.nb_primitives, header.nb_spheres, header.depth))
+            return nullptr;
+
+        const PackedSphere* spheres = reinterpret_cast<const PackedSphere*>(mapping.get_data() + header.spheres_offset);
+        return new LinearBVH(std::move(mapping), nodes, header.nb_nodes, spheres, header.nb_spheres, std::move(primitives), header.depth,
+                             BVHTraversal(header.traversal));
+    }
+
+    // Maps the tree stored for these primitives and settings, or builds and stores it
+    inline LinearBVH* create(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+    {
+        using clock = std::chrono::high_resolution_clock;
+        auto get_seconds = [](clock::time_point _start) { return std::chrono::duration<f64>(clock::now() - _start).count(); };
+
+        BVHCacheStats stats;
+        clock::time_point start = clock::now();
+        const u64 key = compute_key(_hitables, _nb_hitables, _t0, _t1, _settings);
+        stats.path = get_path(_settings.cache_dir, key);
+        stats.key_seconds = get_seconds(start);
+
+        start = clock::now();
+        LinearBVH* bvh = load(stats.path, key, _hitables, _nb_hitables);
+        stats.load_seconds = get_seconds(start);
+        stats.is_hit = (bvh != nullptr);
+
+        if (!bvh)
+        {
+            // The median builder reorders its input, the stored indices refer to the caller's order
+            const std::vector<Hitable*> hitables(_hitables, _hitables + _nb_hitables);
+            start = clock::now();
+            bvh = new LinearBVH(_hitables, _nb_hitables, _t0, _t1, _settings);
+            stats.build_seconds = get_seconds(start);
+
+            start = clock::now();
+            stats.is_stored = store(stats.path, key, *bvh, hitables.data(), _nb_hitables);
+            stats.store_seconds = get_seconds(start);
+        }
+
+        std::error_code error;
+        stats.file_size = std::filesystem::file_size(stats.path, error);
+        if (error)
+            stats.file_size = 0u;
+        if (_settings.cache_stats)
+            *_settings.cache_stats = stats;
+        return bvh;
+    }
+}
+
+// BVHCacheStats //
+
+inline void BVHCacheStats::print() const
+{
+    if (is_hit)
+        util::output_to_console("BVH cache: mapped %s (%.1f MB), key %.3f ms, load %.3f ms", path.string().c_str(), f64(file_size) / (1024. * 1024.),
+                                key_seconds * 1e3, load_seconds * 1e3);
+    else
+        util::output_to_console("BVH cache: miss, built in %.3f ms, %s %s (%.1f MB) in %.3f ms, key %.3f ms", build_seconds * 1e3,
+                                is_stored ? "stored" : "FAILED to store", path.string().c_str(), f64(file_size) / (1024. * 1024.),
+                                store_seconds * 1e3, key_seconds * 1e3);
+}
@@ -0,0 +1,55 @@
+// ======================================================================
+// File: bvhfactory.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "engine/bvh.h"
+#include "engine/bvhcache.h"
+#include "engine/dynamicbvh.h"
+#include "engine/linearbvh.h"
+#include "engine/motionbvh.h"
+#include "engine/outlierbvh.h"
+#include "engine/widebvh.h"
+
+// Builds the tree layout the settings ask for, over the primitives OutlierBVH::split() keeps
+// in it. With a cache directory, the flat layout is mapped from the cache when stored there
+// and stored after building otherwise.
+inline Hitable* create_bvh(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {})
+{
+    return OutlierBVH::create(_hitables, _nb_hitables, _t0, _t1, _settings.outlier_area_ratio, [&](Hitable** _tree_hitables, u32 _nb_tree_hitables) -> Hitable*
+    {
+        switch (_settings.layout)
+        {
+            case BVHLayout::Flat:  return _settings.cache_dir.empty() ? new LinearBVH(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings)
+                                                                      : bvhcache::create(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings);
+            case BVHLayout::Wide4: return new BVH4(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings);
+            case BVHLayout::Wide8: return new BVH8(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings);
+            case BVHLayout::Motion: return new MotionBVH(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings);
+            default:               return new BVH(_tree_hitables, _nb_tree_hitables, _t0, _t1, _settings);
+        }
+    });
+}
+
+// SAH cost of any BVH layout, negative for anything else. Of the tree alone behind an OutlierBVH
+inline f32 get_bvh_sah_cost(const Hitable* _hitable, f32 _traversal_cost = BVHSettings {}.traversal_cost)
+{
+    if (const OutlierBVH* outlier = dynamic_cast<const OutlierBVH*>(_hitable))
+        return outlier->get_bvh() ? get_bvh_sah_cost(outlier->get_bvh(), _traversal_cost) : -1.f;
+    if (const LinearBVH* linear = dynamic_cast<const LinearBVH*>(_hitable))
+        return linear->get_sah_cost(_traversal_cost);
+    if (const BVH4* bvh4 = dynamic_cast<const BVH4*>(_hitable))
+        return bvh4->get_sah_cost(_traversal_cost);
+    if (const BVH8* bvh8 = dynamic_cast<const BVH8*>(_hitable))
+        return bvh8->get_sah_cost(_traversal_cost);
+    if (const DynamicBVH* dynamic = dynamic_cast<const DynamicBVH*>(_hitable))
+        return dynamic->get_sah_cost();
+    if (const MotionBVH* motion = dynamic_cast<const MotionBVH*>(_hitable))
+        return motion->get_sah_cost(_traversal_cost);
+    if (const BVH* bvh = dynamic_cast<const BVH*>(_hitable))
+        return bvh->get_sah_cost(_traversal_cost);
+    return -1.f;
+}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <engine/ray.h>
+#include <core/rng.h>
 
 class Camera
 {
@@ -16,7 +17,7 @@ MOVABLE_ONLY( Camera );
 public:
     inline Camera(const fv3& _look_from, const fv3& _look_at, u32 _img_width, u32 _img_height, f32 _v_FOV, f32 _aperture);
 
-    inline Ray trace_ray(f32 s, f32 t) const;
+    inline Ray trace_ray(f32 s, f32 t, Rng& _rng) const;
 
 private:
     fv3 m_origin;
@@ -54,9 +55,9 @@ inline Camera::Camera(const fv3& _look_from, const fv3& _look_at, u32 _img_width
     m_vertical = 2.f * focalUp;
 }
 
-inline Ray Camera::trace_ray(f32 s, f32 t) const
+inline Ray Camera::trace_ray(f32 s, f32 t, Rng& _rng) const
 {
-    const fv3 rnd_in_lens_disk = m_lens_radius * util::rand_point_in_unit_disk();
+    const fv3 rnd_in_lens_disk = m_lens_radius * util::rand_point_in_unit_disk(_rng);
     const fv3 offset = (m_right * rnd_in_lens_disk.x) + (m_up * rnd_in_lens_disk.y);
     return Ray(m_origin + offset, m_lower_left_corner + s * m_horizontal + t * m_vertical - m_origin - offset);
 }
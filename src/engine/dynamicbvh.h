@@ -0,0 +1,306 @@
+// ======================================================================
+// File: dynamicbvh.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/bvh.h"
+#include "engine/hitable.h"
+#include "engine/linearbvh.h"
+#include "engine/widebvh.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+enum class BVHUpdate
+{
+    Refit,   // bounds only
+    Partial, // bounds, and the degraded subtrees built again
+    Rebuild  // the whole tree built again
+};
+
+inline const utf8* get_name(BVHUpdate _update)
+{
+    switch (_update)
+    {
+        case BVHUpdate::Refit:   return "refit";
+        case BVHUpdate::Partial: return "partial";
+        default:                 return "rebuild";
+    }
+}
+
+// BVH over primitives that move between frames. update() refits the pointer tree to the new
+// positions and compares the SAH cost of every subtree with its cost when it was built; only
+// the bounds change until some subtree grows past BVHSettings::rebuild_ratio. The damage is
+// then followed down as long as it is confined to one child, and the subtree where it spreads
+// over both is rebuilt. When that is most of the tree, or the root is still degraded
+// afterwards, the whole tree is. The flat layout is refitted in place, the wide ones collapsed again.
+class DynamicBVH : public Hitable
+{
+    NON_COPYABLE(DynamicBVH);
+
+public:
+    struct UpdateStats
+    {
+        BVHUpdate update = BVHUpdate::Refit;
+        u32 nb_rebuilt_subtrees = 0u;
+        u32 nb_rebuilt_primitives = 0u;
+        f32 refit_sah_cost = 0.f; // after the refit, before any rebuild
+        f32 sah_cost = 0.f;
+        f64 seconds = 0.;
+
+        inline void print() const;
+    };
+
+public:
+    inline DynamicBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {});
+    virtual inline ~DynamicBVH();
+
+    // Call after moving primitives, never while rendering
+    inline UpdateStats update();
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline void occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    inline f32 get_sah_cost() const;
+
+private:
+    using CostMap = std::unordered_map<const BVH*, f64>;
+
+    inline void rebuild();
+    inline void rebuild_degraded(Hitable** child_, const CostMap& _costs, UpdateStats* stats_);
+    inline b32 is_degraded(const Hitable* _hitable, const CostMap& _costs) const;
+    inline void update_layout(b32 _is_reshaped);
+
+    // Unnormalised SAH cost of every node below _hitable, the root's one is returned
+    inline f64 measure_costs(const Hitable* _hitable, CostMap* costs_) const;
+    inline void forget_costs(const Hitable* _hitable);
+
+private:
+    std::vector<Hitable*> m_hitables; // the median builder reorders its input
+    BVHSettings m_settings;
+    f32 m_t0;
+    f32 m_t1;
+    BVH* m_tree = nullptr;
+    Hitable* m_layout = nullptr; // m_tree itself for the pointer layout
+    CostMap m_build_costs;
+};
+
+// DynamicBVH //
+
+inline DynamicBVH::DynamicBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+    : m_hitables(_hitables, _hitables + _nb_hitables)
+    , m_settings(_settings)
+    , m_t0(_t0)
+    , m_t1(_t1)
+{
+    // Interval bounds cannot be refitted from the children's, motion nodes fall back to flat ones
+    if (m_settings.layout == BVHLayout::Motion)
+    {
+        util::output_to_console("DynamicBVH: the %s layout cannot be refitted, using %s", get_name(BVHLayout::Motion), get_name(BVHLayout::Flat));
+        m_settings.layout = BVHLayout::Flat;
+    }
+    rebuild();
+    update_layout(true);
+}
+
+inline DynamicBVH::~DynamicBVH()
+{
+    if (m_layout != m_tree)
+        util::safe_del(m_layout);
+    util::safe_del(m_tree);
+}
+
+inline void DynamicBVH::rebuild()
+{
+    util::safe_del(m_tree);
+    m_tree = new BVH(m_hitables.data(), u32(m_hitables.size()), m_t0, m_t1, m_settings);
+    m_build_costs.clear();
+    measure_costs(m_tree, &m_build_costs);
+}
+
+inline DynamicBVH::UpdateStats DynamicBVH::update()
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    UpdateStats stats;
+    m_tree->refit(m_t0, m_t1);
+    CostMap costs;
+    measure_costs(m_tree, &costs);
+    stats.refit_sah_cost = m_tree->get_sah_cost(m_settings.traversal_cost);
+
+    // The root holds all the primitives, rebuild_degraded() never replaces it
+    Hitable* root = m_tree;
+    rebuild_degraded(&root, costs, &stats);
+    sws_assert(root == m_tree);
+    if (stats.update == BVHUpdate::Partial)
+    {
+        // A rebuilt subtree bounds the same primitives as before, the ancestors' boxes stay. The root
+        // is still compared with its cost at the last full build, what the subtrees left over counts
+        costs.clear();
+        measure_costs(m_tree, &costs);
+        if (is_degraded(m_tree, costs))
+            stats.update = BVHUpdate::Rebuild;
+    }
+    if (stats.update == BVHUpdate::Rebuild)
+    {
+        rebuild();
+        stats.nb_rebuilt_subtrees = 1u;
+        stats.nb_rebuilt_primitives = u32(m_hitables.size());
+    }
+
+    update_layout(stats.update != BVHUpdate::Refit);
+    stats.sah_cost = m_tree->get_sah_cost(m_settings.traversal_cost);
+    stats.seconds = std::chrono::duration<f64>(std::chrono::high_resolution_clock::now() - start).count();
+    return stats;
+}
+
+inline void DynamicBVH::rebuild_degraded(Hitable** child_, const CostMap& _costs, UpdateStats* stats_)
+{
+    BVH* node = dynamic_cast<BVH*>(*child_);
+    if (!node || node->left == node->right || stats_->update == BVHUpdate::Rebuild)
+        return;
+
+    // Damage confined to one child is fixed down there. A degraded node whose children are
+    // both fine, or both degraded, has a bad split of its own or damage spread over all of it
+    const b32 is_left_degraded = is_degraded(node->left, _costs);
+    const b32 is_right_degraded = is_degraded(node->right, _costs);
+    if (!is_degraded(node, _costs) || is_left_degraded != is_right_degraded)
+    {
+        if (is_left_degraded)
+            rebuild_degraded(&node->left, _costs, stats_);
+        if (is_right_degraded)
+            rebuild_degraded(&node->right, _costs, stats_);
+        return;
+    }
+
+    std::vector<Hitable*> primitives;
+    BVH::collect_primitives(node, &primitives);
+
+    // Most of the tree: one full build is cheaper than patching it in
+    if (2u * primitives.size() > m_hitables.size())
+    {
+        stats_->update = BVHUpdate::Rebuild;
+        return;
+    }
+
+    forget_costs(node);
+    util::safe_del(node);
+
+    BVH* subtree = new BVH(primitives.data(), u32(primitives.size()), m_t0, m_t1, m_settings);
+    measure_costs(subtree, &m_build_costs);
+    *child_ = subtree;
+    stats_->update = BVHUpdate::Partial;
+    ++stats_->nb_rebuilt_subtrees;
+    stats_->nb_rebuilt_primitives += u32(primitives.size());
+}
+
+inline b32 DynamicBVH::is_degraded(const Hitable* _hitable, const CostMap& _costs) const
+{
+    // Single primitives and leaves have no shape to fix
+    const BVH* node = dynamic_cast<const BVH*>(_hitable);
+    if (!node || node->left == node->right)
+        return false;
+
+    const auto build_cost = m_build_costs.find(node);
+    const auto cost = _costs.find(node);
+    sws_assert(build_cost != m_build_costs.end() && cost != _costs.end());
+    return cost->second > build_cost->second * m_settings.rebuild_ratio;
+}
+
+inline void DynamicBVH::update_layout(b32 _is_reshaped)
+{
+    switch (m_settings.layout)
+    {
+        case BVHLayout::Pointer:
+            m_layout = m_tree;
+            break;
+        case BVHLayout::Flat:
+            if (!_is_reshaped && static_cast<LinearBVH*>(m_layout)->refit(m_t0, m_t1))
+                break;
+            util::safe_del(m_layout);
+            m_layout = new LinearBVH(*m_tree, m_t0, m_t1);
+            break;
+        case BVHLayout::Wide4:
+            util::safe_del(m_layout);
+            m_layout = new BVH4(*m_tree, m_t0, m_t1);
+            break;
+        default:
+            util::safe_del(m_layout);
+            m_layout = new BVH8(*m_tree, m_t0, m_t1);
+            break;
+    }
+}
+
+inline f64 DynamicBVH::measure_costs(const Hitable* _hitable, CostMap* costs_) const
+{
+    const BVH* node = dynamic_cast<const BVH*>(_hitable);
+    if (!node)
+        return BVH::accumulate_sah_cost(_hitable, m_settings.traversal_cost);
+
+    f64 cost = m_settings.traversal_cost * node->aabb.get_surface_area() + measure_costs(node->left, costs_);
+    if (node->right != node->left)
+        cost += measure_costs(node->right, costs_);
+    (*costs_)[node] = cost;
+    return cost;
+}
+
+inline void DynamicBVH::forget_costs(const Hitable* _hitable)
+{
+    // The rebuilt subtree's nodes may reuse the freed addresses
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        m_build_costs.erase(node);
+        forget_costs(node->left);
+        if (node->right != node->left)
+            forget_costs(node->right);
+    }
+}
+
+inline b32 DynamicBVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    return m_layout->hit(_ray, _time, _zmin, _zmax, hit_);
+}
+
+inline b32 DynamicBVH::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    return m_layout->occluded(_ray, _time, _zmin, _zmax);
+}
+
+inline void DynamicBVH::occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const
+{
+    m_layout->occluded(_queries, _nb_queries, occluded_);
+}
+
+inline b32 DynamicBVH::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return m_tree->compute_aabb(_time, aabb_);
+}
+
+inline b32 DynamicBVH::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    return m_tree->compute_aabb(_t0, _t1, aabb_);
+}
+
+inline f32 DynamicBVH::get_sah_cost() const
+{
+    return m_tree->get_sah_cost(m_settings.traversal_cost);
+}
+
+// DynamicBVH::UpdateStats //
+
+inline void DynamicBVH::UpdateStats::print() const
+{
+    util::output_to_console("BVH %s: SAH cost %.4f (%.4f refitted), %u subtrees / %u primitives rebuilt, %.3f ms", get_name(update), sah_cost,
+                            refit_sah_cost, nb_rebuilt_subtrees, nb_rebuilt_primitives, seconds * 1e3);
+}
@@ -0,0 +1,108 @@
+// ======================================================================
+// File: framebuffer.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/math/v3.h"
+#include "core/utils.h"
+
+#include <memory>
+#include <new>
+
+// Preallocated RGB8 image, stored top row first as expected by the PNG writer.
+class Framebuffer
+{
+    MOVABLE_ONLY(Framebuffer);
+
+public:
+    // Leaves the pages untouched so the threads that clear them decide on which
+    // NUMA node they are placed (first-touch policy). Pixels are garbage until cleared.
+    struct Uninitialized {};
+
+public:
+    inline Framebuffer(u32 _width, u32 _height);
+    inline Framebuffer(u32 _width, u32 _height, Uninitialized);
+
+    constexpr u32 get_width() const;
+    constexpr u32 get_height() const;
+    constexpr usize get_nb_pixels() const;
+    inline const rgb* get_data() const;
+
+    // _y follows the camera convention: 0 is the bottom row.
+    inline void set_pixel(u32 _x, u32 _y, const rgb& _color);
+    inline const rgb& get_pixel(u32 _x, u32 _y) const;
+
+    // Clears [_x0, _x1) x [_y0, _y1), same convention as set_pixel
+    inline void clear_region(u32 _x0, u32 _y0, u32 _x1, u32 _y1);
+
+private:
+    struct Deleter
+    {
+        void operator()(rgb* _data) const { ::operator delete(_data); }
+    };
+
+private:
+    std::unique_ptr<rgb[], Deleter> m_data;
+    u32 m_width;
+    u32 m_height;
+};
+
+inline Framebuffer::Framebuffer(u32 _width, u32 _height)
+    : Framebuffer(_width, _height, Uninitialized {})
+{
+    clear_region(0u, 0u, m_width, m_height);
+}
+
+inline Framebuffer::Framebuffer(u32 _width, u32 _height, Uninitialized)
+    : m_data(static_cast<rgb*>(::operator new(usize(_width) * usize(_height) * sizeof(rgb))))
+    , m_width(_width)
+    , m_height(_height)
+{
+}
+
+inline constexpr u32 Framebuffer::get_width() const
+{
+    return m_width;
+}
+
+inline constexpr u32 Framebuffer::get_height() const
+{
+    return m_height;
+}
+
+inline constexpr usize Framebuffer::get_nb_pixels() const
+{
+    return usize(m_width) * usize(m_height);
+}
+
+inline const rgb* Framebuffer::get_data() const
+{
+    return m_data.get();
+}
+
+inline void Framebuffer::set_pixel(u32 _x, u32 _y, const rgb& _color)
+{
+    sws_assert(_x < m_width && _y < m_height);
+    m_data[usize(m_height - 1u - _y) * m_width + _x] = _color;
+}
+
+inline const rgb& Framebuffer::get_pixel(u32 _x, u32 _y) const
+{
+    sws_assert(_x < m_width && _y < m_height);
+    return m_data[usize(m_height - 1u - _y) * m_width + _x];
+}
+
+inline void Framebuffer::clear_region(u32 _x0, u32 _y0, u32 _x1, u32 _y1)
+{
+    sws_assert(_x0 <= _x1 && _x1 <= m_width && _y0 <= _y1 && _y1 <= m_height);
+    for (u32 y = _y0; y < _y1; ++y)
+    {
+        rgb* row = m_data.get() + usize(m_height - 1u - y) * m_width;
+        for (u32 x = _x0; x < _x1; ++x)
+            row[x] = rgb::zero();
+    }
+}
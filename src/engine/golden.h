@@ -0,0 +1,77 @@
+// ======================================================================
+// File: golden.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "engine/framebuffer.h"
+#include "engine/texture.h" // stb_image
+
+#include <string>
+
+// Reference image checks for deterministic renders: the output has to match the
+// stored image byte for byte, any difference means the renderer changed behaviour.
+namespace golden
+{
+    struct Result
+    {
+        b32 matches          = false;
+        u32 nb_diff_pixels   = 0u;
+        u32 max_channel_diff = 0u;
+        std::string error    = "";
+    };
+
+    inline fs::path get_default_path(const std::string& _name)
+    {
+        return util::get_data_path() / "golden" / (_name + ".png");
+    }
+
+    inline b32 write(const Framebuffer& _framebuffer, const fs::path& _filepath)
+    {
+        if (_filepath.has_parent_path() && !fs::exists(_filepath.parent_path()))
+            fs::create_directories(_filepath.parent_path());
+
+        return stbi_write_png(_filepath.string().c_str(), _framebuffer.get_width(), _framebuffer.get_height(),
+                              3, _framebuffer.get_data(), 0) != 0;
+    }
+
+    inline Result compare(const Framebuffer& _framebuffer, const fs::path& _filepath)
+    {
+        Result result;
+
+        s32 width = 0, height = 0, bpp = 0;
+        uchar* reference = stbi_load(_filepath.string().c_str(), &width, &height, &bpp, 3);
+        if (!reference)
+        {
+            result.error = "cannot load reference image " + _filepath.string();
+            return result;
+        }
+
+        if (u32(width) != _framebuffer.get_width() || u32(height) != _framebuffer.get_height())
+        {
+            result.error = "size mismatch: reference is " + std::to_string(width) + "x" + std::to_string(height) +
+                           ", render is " + std::to_string(_framebuffer.get_width()) + "x" + std::to_string(_framebuffer.get_height());
+            stbi_image_free(reference);
+            return result;
+        }
+
+        const rgb* pixels = _framebuffer.get_data();
+        for (usize idx = 0u; idx < _framebuffer.get_nb_pixels(); ++idx)
+        {
+            u32 pixel_diff = 0u;
+            for (usize c = 0u; c < 3u; ++c)
+                pixel_diff = math::max(pixel_diff, u32(math::abs(s32(pixels[idx][c]) - s32(reference[idx * 3u + c]))));
+
+            result.nb_diff_pixels += (pixel_diff > 0u) ? 1u : 0u;
+            result.max_channel_diff = math::max(result.max_channel_diff, pixel_diff);
+        }
+        stbi_image_free(reference);
+
+        result.matches = (result.nb_diff_pixels == 0u);
+        return result;
+    }
+}
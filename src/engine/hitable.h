@@ -9,7 +9,8 @@
 
 #include "core/math/v3.h"
 
-class Ray;
+#include "engine/ray.h"
+
 class AABB;
 class Material;
 
@@ -26,6 +27,19 @@ struct Hit
     Material* material = nullptr;
 };
 
+// One ray of a batched occlusion query: is anything in (zmin, zmax) along it at that time
+struct OcclusionQuery
+{
+    MOVABLE_ONLY(OcclusionQuery);
+
+    OcclusionQuery() = default;
+
+    Ray ray;
+    f32 time = 0.f;
+    f32 zmin = 0.f;
+    f32 zmax = 0.f;
+};
+
 class Hitable
 {
 public:
@@ -34,6 +48,39 @@ public:
 
     virtual inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const = 0;
 
+    // Any-hit query for shadow and visibility rays: true on the first hit found in (_zmin, _zmax),
+    // no surface attributes are computed. The default falls back to a closest hit.
+    virtual inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const;
+    // occluded_[i] for each query, the default answers them one by one
+    virtual inline void occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const;
+
+    // hit() and occluded() as called by a parent BVH node: nested nodes add their visits to
+    // nb_visits_ and the root reports the total once. Anything else is the plain query.
+    virtual inline b32 hit_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_, u32* nb_visits_) const;
+    virtual inline b32 occluded_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, u32* nb_visits_) const;
+
     virtual inline b32 compute_aabb(f32 _time, AABB* aabb_) const = 0;
     virtual inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const = 0;
-};
\ No newline at end of file
+};
+
+inline b32 Hitable::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    Hit tmp_hit;
+    return hit(_ray, _time, _zmin, _zmax, &tmp_hit);
+}
+
+inline void Hitable::occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const
+{
+    for (u32 idx = 0u; idx < _nb_queries; ++idx)
+        occluded_[idx] = occluded(_queries[idx].ray, _queries[idx].time, _queries[idx].zmin, _queries[idx].zmax);
+}
+
+inline b32 Hitable::hit_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_, u32*) const
+{
+    return hit(_ray, _time, _zmin, _zmax, hit_);
+}
+
+inline b32 Hitable::occluded_subtree(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, u32*) const
+{
+    return occluded(_ray, _time, _zmin, _zmax);
+}
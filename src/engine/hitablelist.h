@@ -28,6 +28,8 @@ public:
     constexpr u32 get_size() const;
 
     inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
     inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
     inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
 
@@ -111,6 +113,16 @@ inline b32 HitableList::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hi
     return has_hit_anything;
 }
 
+inline b32 HitableList::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    for (usize idx = 0; idx < m_size; ++idx)
+    {
+        if (m_hitables[idx]->occluded(_ray, _time, _zmin, _zmax))
+            return true;
+    }
+    return false;
+}
+
 inline b32 HitableList::compute_aabb(f32 _time, AABB* aabb_) const
 {
     return false;
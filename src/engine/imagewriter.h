@@ -0,0 +1,119 @@
+// ======================================================================
+// File: imagewriter.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "engine/framebuffer.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// PNG output of finished framebuffers. The frame pipeline runs write() as its own task, so
+// frame N is encoded while frame N+1 is traced; how far tracing may run ahead of the encoder
+// is bounded by the pipeline's dependencies (--output-queue), not here.
+class ImageWriter
+{
+    NON_COPYABLE(ImageWriter);
+
+public:
+    struct Stats
+    {
+        inline void print() const;
+
+        u32 nb_frames        = 0u;
+        u32 nb_failed        = 0u;
+        u64 nb_bytes         = 0u;
+        f64 encode_seconds   = 0.;
+        f64 write_seconds    = 0.;
+    };
+
+public:
+    ImageWriter() = default;
+
+    // Thread safe, several frames can be written at the same time
+    inline b32 write(const std::string& _filename, const Framebuffer& _framebuffer);
+
+    // Sidecar file next to the image, <filename>.json
+    static inline b32 write_metadata(const std::string& _filename, const std::string& _json);
+
+    inline Stats get_stats() const;
+
+private:
+    mutable std::mutex m_mutex;
+    Stats m_stats;
+};
+
+// ImageWriter::Stats //
+
+inline void ImageWriter::Stats::print() const
+{
+    util::output_to_console("Output: %u frames, %.2f MB, encode %.3fs (avg %.3fs), write %.3fs (avg %.3fs)",
+                            nb_frames, f64(nb_bytes) / (1024. * 1024.),
+                            encode_seconds, (nb_frames > 0u) ? encode_seconds / nb_frames : 0.,
+                            write_seconds, (nb_frames > 0u) ? write_seconds / nb_frames : 0.);
+    if (nb_failed > 0u)
+        util::output_to_console("Output: %u frames could not be written", nb_failed);
+}
+
+// ImageWriter //
+
+inline ImageWriter::Stats ImageWriter::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+inline b32 ImageWriter::write(const std::string& _filename, const Framebuffer& _framebuffer)
+{
+    const Framebuffer& fb = _framebuffer;
+
+    const auto encode_start = std::chrono::high_resolution_clock::now();
+    std::vector<u8> png;
+    png.reserve(fb.get_nb_pixels());
+    const b32 is_encoded = stbi_write_png_to_func([](void* _ctx, void* _data, s32 _size)
+    {
+        std::vector<u8>& out = *static_cast<std::vector<u8>*>(_ctx);
+        out.insert(out.end(), static_cast<const u8*>(_data), static_cast<const u8*>(_data) + _size);
+    }, &png, fb.get_width(), fb.get_height(), 3, fb.get_data(), 0);
+    const auto encode_end = std::chrono::high_resolution_clock::now();
+
+    b32 is_written = false;
+    if (is_encoded)
+    {
+        std::error_code error;
+        fs::create_directory(util::get_output_path(), error);
+
+        std::ofstream file_stream(util::get_output_path() / (_filename + ".png"), std::ios::binary);
+        file_stream.write(reinterpret_cast<const utf8*>(png.data()), std::streamsize(png.size()));
+        file_stream.close();
+        is_written = file_stream.good();
+    }
+    const auto write_end = std::chrono::high_resolution_clock::now();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.nb_frames += 1u;
+    m_stats.nb_failed += is_written ? 0u : 1u;
+    m_stats.nb_bytes  += png.size();
+    m_stats.encode_seconds += std::chrono::duration<f64>(encode_end - encode_start).count();
+    m_stats.write_seconds  += std::chrono::duration<f64>(write_end - encode_end).count();
+    return is_written;
+}
+
+inline b32 ImageWriter::write_metadata(const std::string& _filename, const std::string& _json)
+{
+    std::error_code error;
+    fs::create_directory(util::get_output_path(), error);
+
+    std::ofstream file_stream(util::get_output_path() / (_filename + ".json"), std::ios::binary);
+    file_stream << _json;
+    file_stream.close();
+    return file_stream.good();
+}
@@ -0,0 +1,161 @@
+// ======================================================================
+// File: instance.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "core/math/aabb.h"
+#include "core/math/affine.h"
+
+#include "engine/bvhfactory.h"
+#include "engine/hitable.h"
+#include "engine/hitablelist.h"
+#include "engine/ray.h"
+
+#include <memory>
+
+// Geometry meant to be placed many times: object-space primitives and the bottom-level BVH
+// over them, both owned. Only traced through the instances referencing it.
+class InstanceGeometry : public Hitable
+{
+    NON_COPYABLE(InstanceGeometry);
+
+public:
+    inline InstanceGeometry(HitableList* _primitives, const BVHSettings& _settings = {});
+    virtual inline ~InstanceGeometry();
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline void occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    inline u32 get_nb_primitives() const;
+
+private:
+    HitableList* m_primitives = nullptr;
+    Hitable* m_bvh = nullptr;
+};
+
+// One placement of shared geometry. Rays are taken to object space and traced through the
+// object's own BVH, so a top-level BVH over instances costs one node per placement whatever
+// the geometry holds. The object-space direction is normalised again like any ray's, hit
+// distances are scaled back to world units for the BVHs above to compare.
+class Instance : public Hitable
+{
+public:
+    inline Instance(std::shared_ptr<const Hitable> _object, const Affine& _object_to_world);
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    inline const Hitable* get_object() const;
+
+private:
+    std::shared_ptr<const Hitable> m_object;
+    Affine m_world_to_object;
+    AABB m_bounds; // world space, over the object's bounds for the whole shutter
+};
+
+// InstanceGeometry //
+
+inline InstanceGeometry::InstanceGeometry(HitableList* _primitives, const BVHSettings& _settings)
+    : m_primitives(_primitives)
+    , m_bvh(create_bvh(_primitives->get_buffer(), _primitives->get_size(), 0.f, 1.f, _settings))
+{
+}
+
+inline InstanceGeometry::~InstanceGeometry()
+{
+    util::safe_del(m_bvh);
+    util::safe_del(m_primitives);
+}
+
+inline b32 InstanceGeometry::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    return m_bvh->hit(_ray, _time, _zmin, _zmax, hit_);
+}
+
+inline b32 InstanceGeometry::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    return m_bvh->occluded(_ray, _time, _zmin, _zmax);
+}
+
+inline void InstanceGeometry::occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const
+{
+    m_bvh->occluded(_queries, _nb_queries, occluded_);
+}
+
+inline b32 InstanceGeometry::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return m_bvh->compute_aabb(_time, aabb_);
+}
+
+inline b32 InstanceGeometry::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    return m_bvh->compute_aabb(_t0, _t1, aabb_);
+}
+
+inline u32 InstanceGeometry::get_nb_primitives() const
+{
+    return m_primitives->get_size();
+}
+
+// Instance //
+
+inline Instance::Instance(std::shared_ptr<const Hitable> _object, const Affine& _object_to_world)
+    : m_object(std::move(_object))
+    , m_world_to_object(_object_to_world.get_inverse())
+{
+    AABB object_bounds;
+    if (!m_object->compute_aabb(0.f, 1.f, &object_bounds))
+        util::output_to_console("No bounding box in Instance constructor.");
+    m_bounds = _object_to_world.transform_box(object_bounds);
+}
+
+inline b32 Instance::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    // A scaling map stretches the direction: object distances are this many times the world ones
+    const fv3 object_direction = m_world_to_object.transform_vector(_ray.direction);
+    const f32 scale = object_direction.get_length();
+    const Ray object_ray(m_world_to_object.transform_point(_ray.origin), object_direction);
+    if (!m_object->hit(object_ray, _time, _zmin * scale, _zmax * scale, hit_))
+        return false;
+
+    hit_->distance /= scale;
+    hit_->point = _ray.point_at(hit_->distance);
+    hit_->normal = m_world_to_object.transform_normal(hit_->normal).get_normalized();
+    return true;
+}
+
+inline b32 Instance::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    const fv3 object_direction = m_world_to_object.transform_vector(_ray.direction);
+    const f32 scale = object_direction.get_length();
+    const Ray object_ray(m_world_to_object.transform_point(_ray.origin), object_direction);
+    return m_object->occluded(object_ray, _time, _zmin * scale, _zmax * scale);
+}
+
+inline b32 Instance::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    *aabb_ = m_bounds;
+    return true;
+}
+
+inline b32 Instance::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    *aabb_ = m_bounds;
+    return true;
+}
+
+inline const Hitable* Instance::get_object() const
+{
+    return m_object.get();
+}
@@ -0,0 +1,552 @@
+// ======================================================================
+// File: linearbvh.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/mappedfile.h"
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/bvh.h"
+#include "engine/hitable.h"
+#include "engine/ray.h"
+#include "engine/sphere.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <emmintrin.h>
+
+// A finished BVH compacted into one array of 32-byte nodes in depth-first order: the
+// first child of an interior node is the next node, the second one is at `offset`.
+// Leaves own a range of a flat primitive array. hit() walks the array with a small
+// explicit stack, only the primitives themselves are called through Hitable. Ordered
+// traversal descends into the child on the ray's side of the split axis first. The node
+// array can also live in a mapped BVH cache file and be traced from there in place.
+// Subtrees of up to max_leaf_size primitives collapse into one leaf where the SAH says a
+// leaf is cheaper, whichever builder made the tree. Leaves of spheres are packed: their
+// geometry is copied next to each other in leaf order and tested in one tight loop, the
+// Sphere objects are only reached for the material of the closest hit. Packed leaves take
+// the first primitive slots, so the sphere array is indexed like them and holds nothing else.
+class LinearBVH : public Hitable
+{
+    NON_COPYABLE(LinearBVH);
+
+public:
+    struct alignas(32) Node
+    {
+        fv3 min;
+        u32 offset;        // leaf: first primitive, interior: second child
+        fv3 max;
+        u16 nb_primitives; // 0 for interior nodes
+        u8 axis;           // interior: split axis, the first child is on its lower side
+        u8 is_packed;      // leaf: only spheres, tested from the packed sphere array
+    };
+    static_assert(sizeof(Node) == 32u && offsetof(Node, max) == 16u);
+
+    static constexpr u32 k_stack_size = 64u; // traversal stack on the call stack, deeper trees use a heap one
+
+public:
+    inline LinearBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {});
+    inline LinearBVH(const BVH& _bvh, f32 _t0, f32 _t1); // keeps the tree's traversal order
+    // Nodes stored in _mapping, which stays open as long as the tree
+    inline LinearBVH(MappedFile&& _mapping, const Node* _nodes, u32 _nb_nodes, const PackedSphere* _spheres, u32 _nb_spheres,
+                     std::vector<Hitable*>&& _primitives, u32 _depth, BVHTraversal _traversal);
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    // Traces the batch as a stream: each node is fetched once for all the rays still active
+    // below it and filtered against their boxes; rays leave the stream once occluded
+    inline void occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    // BVH::refit on the array: children always come after their parent, so one backwards
+    // pass sees both of them before it. Packed spheres are copied again. Mapped nodes are
+    // read-only: returns false and leaves them as they are
+    inline b32 refit(f32 _t0, f32 _t1);
+
+    // Same metric as BVH::get_sah_cost
+    inline f32 get_sah_cost(f32 _traversal_cost = BVHSettings {}.traversal_cost) const;
+
+    inline u32 get_nb_nodes() const;
+    inline u32 get_depth() const;
+    inline const Node* get_nodes() const;
+    inline u32 get_nb_spheres() const;
+    inline const PackedSphere* get_spheres() const; // one per slot of the packed leaves, the first primitive slots
+    inline const std::vector<Hitable*>& get_primitives() const;
+    inline BVHTraversal get_traversal() const;
+
+private:
+    inline void flatten(const BVH& _bvh, f32 _t0, f32 _t1, u32 _max_leaf_size, f32 _traversal_cost);
+    inline u32 flatten_node(const Hitable* _hitable, f32 _t0, f32 _t1, u32 _depth, u32 _max_leaf_size, f32 _traversal_cost);
+    inline u32 add_leaf(const Hitable* const* _hitables, u32 _nb_hitables, const AABB& _bounds);
+    inline void pack_spheres();
+
+    // Closest hit among a leaf's primitives nearer than closest_dist_, which it shrinks
+    inline b32 hit_leaf(const Node& _node, const Ray& _ray, f32 _time, f32 _zmin, f32* closest_dist_, Hit* hit_) const;
+    inline b32 is_leaf_occluding(const Node& _node, const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const;
+    static inline u32 count_primitives(const Hitable* _hitable, u32 _limit); // stops past _limit
+
+    static inline b32 is_hit(const Node& _node, const Ray& _ray, f32 _tmin, f32 _tmax);
+
+private:
+    std::vector<Node> m_nodes;          // empty when mapped
+    MappedFile m_mapping;
+    const Node* m_node_data = nullptr;  // m_nodes or the mapped file
+    u32 m_nb_nodes = 0u;
+    std::vector<PackedSphere> m_spheres; // empty when mapped
+    const PackedSphere* m_sphere_data = nullptr;
+    u32 m_nb_spheres = 0u;
+    std::vector<Hitable*> m_primitives; // leaf order
+    u32 m_depth = 0u;
+    BVHTraversal m_traversal = BVHTraversal::Ordered;
+};
+
+inline LinearBVH::LinearBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+{
+    flatten(BVH(_hitables, _nb_hitables, _t0, _t1, _settings), _t0, _t1, _settings.max_leaf_size, _settings.traversal_cost);
+    m_traversal = _settings.traversal;
+}
+
+inline LinearBVH::LinearBVH(const BVH& _bvh, f32 _t0, f32 _t1)
+{
+    flatten(_bvh, _t0, _t1, 1u, BVHSettings {}.traversal_cost);
+    m_traversal = _bvh.traversal;
+}
+
+inline LinearBVH::LinearBVH(MappedFile&& _mapping, const Node* _nodes, u32 _nb_nodes, const PackedSphere* _spheres, u32 _nb_spheres,
+                            std::vector<Hitable*>&& _primitives, u32 _depth, BVHTraversal _traversal)
+    : m_mapping(std::move(_mapping))
+    , m_node_data(_nodes)
+    , m_nb_nodes(_nb_nodes)
+    , m_sphere_data(_spheres)
+    , m_nb_spheres(_nb_spheres)
+    , m_primitives(std::move(_primitives))
+    , m_depth(_depth)
+    , m_traversal(_traversal)
+{
+}
+
+inline void LinearBVH::flatten(const BVH& _bvh, f32 _t0, f32 _t1, u32 _max_leaf_size, f32 _traversal_cost)
+{
+    m_nodes.clear();
+    m_spheres.clear();
+    m_primitives.clear();
+    m_depth = 0u;
+
+    flatten_node(&_bvh, _t0, _t1, 1u, math::min(_max_leaf_size, u32(std::numeric_limits<u16>::max())), _traversal_cost);
+    pack_spheres();
+    m_node_data = m_nodes.data();
+    m_nb_nodes = u32(m_nodes.size());
+    m_sphere_data = m_spheres.data();
+    m_nb_spheres = u32(m_spheres.size());
+}
+
+inline u32 LinearBVH::flatten_node(const Hitable* _hitable, f32 _t0, f32 _t1, u32 _depth, u32 _max_leaf_size, f32 _traversal_cost)
+{
+    m_depth = math::max(m_depth, _depth);
+
+    // A single-primitive BVH node points twice at the same primitive
+    const BVH* node = dynamic_cast<const BVH*>(_hitable);
+    if (node && node->left == node->right)
+        return add_leaf(&node->left, 1u, node->aabb);
+
+    // Same comparison as the SAH build's, on the subtree as built: one test per primitive
+    // in this box against visiting the subtree's nodes and leaves, both scaled by area
+    if (node && count_primitives(node, _max_leaf_size) <= _max_leaf_size)
+    {
+        std::vector<Hitable*> hitables;
+        BVH::collect_primitives(node, &hitables);
+        if (f64(hitables.size()) * node->aabb.get_surface_area() <= BVH::accumulate_sah_cost(node, _traversal_cost))
+            return add_leaf(hitables.data(), u32(hitables.size()), node->aabb);
+    }
+
+    if (node)
+    {
+        const u32 idx = u32(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes[idx].min = node->aabb.min;
+        m_nodes[idx].max = node->aabb.max;
+        m_nodes[idx].nb_primitives = 0u;
+        m_nodes[idx].axis = node->split_axis;
+        flatten_node(node->left, _t0, _t1, _depth + 1u, _max_leaf_size, _traversal_cost);
+        // Indices, not references: the vector grows while the children are added
+        m_nodes[idx].offset = flatten_node(node->right, _t0, _t1, _depth + 1u, _max_leaf_size, _traversal_cost);
+        return idx;
+    }
+
+    if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+    {
+        AABB bounds;
+        leaf->compute_aabb(_t0, _t1, &bounds);
+        return add_leaf(leaf->get_hitables().data(), leaf->get_size(), bounds);
+    }
+
+    AABB bounds;
+    _hitable->compute_aabb(_t0, _t1, &bounds);
+    return add_leaf(&_hitable, 1u, bounds);
+}
+
+inline u32 LinearBVH::add_leaf(const Hitable* const* _hitables, u32 _nb_hitables, const AABB& _bounds)
+{
+    const u32 idx = u32(m_nodes.size());
+    Node& node = m_nodes.emplace_back();
+    node.min = _bounds.min;
+    node.max = _bounds.max;
+    node.offset = u32(m_primitives.size());
+    node.nb_primitives = u16(_nb_hitables);
+    node.is_packed = 1u;
+    for (u32 primitive = 0u; primitive < _nb_hitables; ++primitive)
+    {
+        m_primitives.push_back(const_cast<Hitable*>(_hitables[primitive]));
+        node.is_packed &= (dynamic_cast<const Sphere*>(_hitables[primitive]) != nullptr) ? 1u : 0u;
+    }
+    return idx;
+}
+
+inline void LinearBVH::pack_spheres()
+{
+    // Packed leaves move to the front of the primitive array, each kind keeping its leaf order,
+    // and copy their spheres at the same indices
+    std::vector<Hitable*> primitives;
+    primitives.reserve(m_primitives.size());
+    for (const u8 is_packed : { u8(1u), u8(0u) })
+    {
+        for (Node& node : m_nodes)
+        {
+            if (node.nb_primitives == 0u || node.is_packed != is_packed)
+                continue;
+            const u32 offset = u32(primitives.size());
+            for (u32 primitive = node.offset; primitive < node.offset + node.nb_primitives; ++primitive)
+            {
+                primitives.push_back(m_primitives[primitive]);
+                if (is_packed)
+                    m_spheres.push_back(static_cast<const Sphere*>(m_primitives[primitive])->get_packed());
+            }
+            node.offset = offset;
+        }
+    }
+    m_primitives = std::move(primitives);
+}
+
+inline b32 LinearBVH::hit_leaf(const Node& _node, const Ray& _ray, f32 _time, f32 _zmin, f32* closest_dist_, Hit* hit_) const
+{
+    if (!_node.is_packed)
+    {
+        b32 has_hit_anything = false;
+        for (u32 idx = _node.offset; idx < _node.offset + _node.nb_primitives; ++idx)
+        {
+            Hit tmp_hit;
+            if (m_primitives[idx]->hit(_ray, _time, _zmin, *closest_dist_, &tmp_hit))
+            {
+                has_hit_anything = true;
+                *closest_dist_ = tmp_hit.distance;
+                *hit_ = std::move(tmp_hit);
+            }
+        }
+        return has_hit_anything;
+    }
+
+    // Roots only, the hit record is filled once for the closest sphere
+    u32 closest_idx = ~0u;
+    for (u32 idx = _node.offset; idx < _node.offset + _node.nb_primitives; ++idx)
+    {
+        f32 root;
+        if (Sphere::find_root(m_sphere_data[idx].get_center(_time), m_sphere_data[idx].sqr_radius, _ray, _zmin, *closest_dist_, &root))
+        {
+            *closest_dist_ = root;
+            closest_idx = idx;
+        }
+    }
+    if (closest_idx == ~0u)
+        return false;
+
+    const PackedSphere& sphere = m_sphere_data[closest_idx];
+    Sphere::set_hit(sphere.get_center(_time), sphere.radius, static_cast<const Sphere*>(m_primitives[closest_idx])->material, _ray, *closest_dist_, hit_);
+    return true;
+}
+
+inline b32 LinearBVH::is_leaf_occluding(const Node& _node, const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    for (u32 idx = _node.offset; idx < _node.offset + _node.nb_primitives; ++idx)
+    {
+        const b32 is_occluding = _node.is_packed ? Sphere::has_root(m_sphere_data[idx].get_center(_time), m_sphere_data[idx].sqr_radius, _ray, _zmin, _zmax)
+                                                 : m_primitives[idx]->occluded(_ray, _time, _zmin, _zmax);
+        if (is_occluding)
+            return true;
+    }
+    return false;
+}
+
+inline u32 LinearBVH::count_primitives(const Hitable* _hitable, u32 _limit)
+{
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        const u32 nb_left = count_primitives(node->left, _limit);
+        if (node->right == node->left || nb_left > _limit)
+            return nb_left;
+        return nb_left + count_primitives(node->right, _limit - nb_left);
+    }
+    if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+        return leaf->get_size();
+    return 1u;
+}
+
+inline b32 LinearBVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    if (m_nb_nodes == 0u)
+        return false;
+
+    const b32 is_ordered = (m_traversal == BVHTraversal::Ordered);
+
+    // Traversal pushes at most one node per level
+    u32 local_stack[k_stack_size];
+    std::vector<u32> heap_stack((m_depth > k_stack_size) ? m_depth : 0u);
+    u32* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    u32 node_idx = 0u;
+    b32 has_hit_anything = false;
+    f32 closest_dist = _zmax;
+    u32 nb_visits = 0u;
+    for (;;)
+    {
+        const Node& node = m_node_data[node_idx];
+        ++nb_visits;
+        // Boxes are tested against the closest hit so far, farther subtrees are skipped
+        if (is_hit(node, _ray, _zmin, closest_dist))
+        {
+            if (node.nb_primitives == 0u)
+            {
+                // The far child waits on the stack, by then the near one may have shrunk closest_dist
+                const b32 is_second_near = is_ordered && _ray.sign[node.axis];
+                stack[stack_size++] = is_second_near ? node_idx + 1u : node.offset;
+                node_idx = is_second_near ? node.offset : node_idx + 1u;
+                continue;
+            }
+
+            has_hit_anything |= hit_leaf(node, _ray, _time, _zmin, &closest_dist, hit_);
+        }
+
+        if (stack_size == 0u)
+            break;
+        node_idx = stack[--stack_size];
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return has_hit_anything;
+}
+
+inline b32 LinearBVH::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    if (m_nb_nodes == 0u)
+        return false;
+
+    u32 local_stack[k_stack_size];
+    std::vector<u32> heap_stack((m_depth > k_stack_size) ? m_depth : 0u);
+    u32* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    u32 node_idx = 0u;
+    u32 nb_visits = 0u;
+    b32 is_occluded = false;
+    for (;;)
+    {
+        const Node& node = m_node_data[node_idx];
+        ++nb_visits;
+        if (is_hit(node, _ray, _zmin, _zmax))
+        {
+            if (node.nb_primitives == 0u)
+            {
+                stack[stack_size++] = node.offset;
+                node_idx = node_idx + 1u;
+                continue;
+            }
+
+            is_occluded = is_leaf_occluding(node, _ray, _time, _zmin, _zmax);
+            if (is_occluded)
+                break;
+        }
+
+        if (stack_size == 0u)
+            break;
+        node_idx = stack[--stack_size];
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return is_occluded;
+}
+
+inline void LinearBVH::occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const
+{
+    for (u32 idx = 0u; idx < _nb_queries; ++idx)
+        occluded_[idx] = false;
+    if (m_nb_nodes == 0u || _nb_queries == 0u)
+        return;
+
+    // Every stack entry owns a range of `active`, the rays that reached its parent. A node's
+    // filtered rays are written right past its range: the entries below it on the stack own
+    // earlier ranges, so whatever lay there belonged to entries already popped.
+    struct StackEntry
+    {
+        u32 node_idx;
+        u32 begin;
+        u32 end;
+    };
+    StackEntry local_stack[k_stack_size + 1u]; // both children are pushed, one level more than hit()
+    std::vector<StackEntry> heap_stack((m_depth > k_stack_size) ? m_depth + 1u : 0u);
+    StackEntry* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+
+    // Ranges down a path sit one after the other and none holds more than the batch
+    std::vector<u32> active(usize(_nb_queries) * (m_depth + 2u));
+    for (u32 idx = 0u; idx < _nb_queries; ++idx)
+        active[idx] = idx;
+    stack[stack_size++] = { 0u, 0u, _nb_queries };
+
+    u32 nb_visits = 0u;
+    while (stack_size > 0u)
+    {
+        const StackEntry entry = stack[--stack_size];
+        const Node& node = m_node_data[entry.node_idx];
+
+        const u32 begin = entry.end;
+        u32 end = begin;
+        for (u32 pos = entry.begin; pos < entry.end; ++pos)
+        {
+            const u32 query_idx = active[pos];
+            const OcclusionQuery& query = _queries[query_idx];
+            if (occluded_[query_idx])
+                continue;
+            ++nb_visits;
+            if (is_hit(node, query.ray, query.zmin, query.zmax))
+                active[end++] = query_idx;
+        }
+        if (begin == end)
+            continue;
+
+        if (node.nb_primitives == 0u)
+        {
+            stack[stack_size++] = { node.offset, begin, end };
+            stack[stack_size++] = { entry.node_idx + 1u, begin, end };
+            continue;
+        }
+
+        for (u32 pos = begin; pos < end; ++pos)
+        {
+            const u32 query_idx = active[pos];
+            const OcclusionQuery& query = _queries[query_idx];
+            occluded_[query_idx] = is_leaf_occluding(node, query.ray, query.time, query.zmin, query.zmax);
+        }
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+}
+
+inline b32 LinearBVH::is_hit(const Node& _node, const Ray& _ray, f32 _tmin, f32 _tmax)
+{
+    // min and max each start a 16-byte half of the node. The fourth lanes hold the offset and
+    // counts, small integers that read as denormals and would slow the float math down: zero them
+    const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    return AABB::is_hit(_mm_and_ps(_mm_load_ps(&_node.min.x), xyz_mask), _mm_and_ps(_mm_load_ps(&_node.max.x), xyz_mask), _ray, _tmin, _tmax);
+}
+
+inline b32 LinearBVH::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return compute_aabb(_time, _time, aabb_);
+}
+
+inline b32 LinearBVH::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    if (m_nb_nodes == 0u)
+        return false;
+    aabb_->set(m_node_data[0].min, m_node_data[0].max);
+    return true;
+}
+
+inline b32 LinearBVH::refit(f32 _t0, f32 _t1)
+{
+    if (m_mapping.is_open())
+        return false;
+
+    for (u32 idx = u32(m_nodes.size()); idx-- > 0u;)
+    {
+        Node& node = m_nodes[idx];
+        AABB bounds;
+        if (node.nb_primitives == 0u)
+        {
+            const Node& first = m_nodes[idx + 1u];
+            const Node& second = m_nodes[node.offset];
+            bounds = AABB::get_surrounding_box(AABB(first.min, first.max), AABB(second.min, second.max));
+        }
+        else
+        {
+            for (u32 primitive = node.offset; primitive < node.offset + node.nb_primitives; ++primitive)
+            {
+                if (node.is_packed)
+                    m_spheres[primitive] = static_cast<const Sphere*>(m_primitives[primitive])->get_packed();
+                AABB primitive_bounds;
+                m_primitives[primitive]->compute_aabb(_t0, _t1, &primitive_bounds);
+                bounds = (primitive == node.offset) ? primitive_bounds : AABB::get_surrounding_box(bounds, primitive_bounds);
+            }
+        }
+        node.min = bounds.min;
+        node.max = bounds.max;
+    }
+    return true;
+}
+
+inline f32 LinearBVH::get_sah_cost(f32 _traversal_cost) const
+{
+    if (m_nb_nodes == 0u)
+        return 0.f;
+
+    auto get_area = [](const Node& _node) { return AABB(_node.min, _node.max).get_surface_area(); };
+    const f32 root_area = get_area(m_node_data[0]);
+    if (root_area <= 0.f)
+        return 0.f;
+
+    f64 cost = 0.;
+    for (u32 idx = 0u; idx < m_nb_nodes; ++idx)
+    {
+        const Node& node = m_node_data[idx];
+        cost += get_area(node) * ((node.nb_primitives == 0u) ? _traversal_cost : f32(node.nb_primitives));
+    }
+    return f32(cost / root_area);
+}
+
+inline u32 LinearBVH::get_nb_nodes() const
+{
+    return m_nb_nodes;
+}
+
+inline u32 LinearBVH::get_depth() const
+{
+    return m_depth;
+}
+
+inline const LinearBVH::Node* LinearBVH::get_nodes() const
+{
+    return m_node_data;
+}
+
+inline u32 LinearBVH::get_nb_spheres() const
+{
+    return m_nb_spheres;
+}
+
+inline const PackedSphere* LinearBVH::get_spheres() const
+{
+    return m_sphere_data;
+}
+
+inline const std::vector<Hitable*>& LinearBVH::get_primitives() const
+{
+    return m_primitives;
+}
+
+inline BVHTraversal LinearBVH::get_traversal() const
+{
+    return m_traversal;
+}
@@ -19,7 +19,7 @@ public:
     Material() = default;
     virtual ~Material() noexcept = default;
 
-    virtual b32 scatter(const Ray& _ray, const Hit& _hit, fv3* _attenuation, Ray* _scattered) const noexcept = 0;
+    virtual b32 scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* _attenuation, Ray* _scattered) const noexcept = 0;
 
     static constexpr fv3 reflect(const fv3& _incident, const fv3& _normal) noexcept;
     static constexpr b32 refract(const fv3& _incident, const fv3& _normal, f32 _refractive_ratio, fv3* _refracted) noexcept;
@@ -36,7 +36,7 @@ public:
     constexpr Lambertian& operator=(Lambertian&& _other) noexcept;
     virtual inline ~Lambertian();
 
-    inline b32 scatter(const Ray& _ray, const Hit& _hit, fv3* attenuation_, Ray* scattered_) const noexcept override;
+    inline b32 scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* attenuation_, Ray* scattered_) const noexcept override;
 
 public:
     Texture* albedo;
@@ -49,7 +49,7 @@ class Metal : public Material
 public:
     constexpr Metal(const fv3& _albedo, f32 _fuzziness) noexcept;
 
-    inline b32 scatter(const Ray& _ray, const Hit& Hit, fv3* attenuation, Ray* scattered) const noexcept override;
+    inline b32 scatter(const Ray& _ray, const Hit& Hit, Rng& _rng, fv3* attenuation, Ray* scattered) const noexcept override;
 
 public:
     fv3 albedo;
@@ -63,7 +63,7 @@ class Dielectric : public Material
 public:
     constexpr Dielectric(f32 _refractive_idx) noexcept;
 
-    inline b32 scatter(const Ray& _ray, const Hit& _hit, fv3* attenuation_, Ray* scattered_) const noexcept override;
+    inline b32 scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* attenuation_, Ray* scattered_) const noexcept override;
 
 public:
     f32 refractive_idx;
@@ -123,11 +123,11 @@ inline Lambertian::~Lambertian()
     util::safe_del(albedo);
 }
 
-inline b32 Lambertian::scatter(const Ray& _ray, const Hit& _hit, fv3* attenuation_, Ray* scattered_) const noexcept
+inline b32 Lambertian::scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* attenuation_, Ray* scattered_) const noexcept
 {
     sws_assert(attenuation_ && scattered_);
 
-    const fv3 target = _hit.point + _hit.normal + util::rand_point_in_unit_sphere();
+    const fv3 target = _hit.point + _hit.normal + util::rand_point_in_unit_sphere(_rng);
     *attenuation_ = albedo->value(_hit.uv, _hit.point); // TODO(jserrano): add scattering probability
     *scattered_ = Ray(_hit.point, target - _hit.point);
     return true;
@@ -141,12 +141,12 @@ constexpr Metal::Metal(const fv3& albedo, f32 fuzziness) noexcept
 {
 }
 
-inline b32 Metal::scatter(const Ray& _ray, const Hit& _hit, fv3* _attenuation, Ray* _scattered) const noexcept
+inline b32 Metal::scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* _attenuation, Ray* _scattered) const noexcept
 {
     sws_assert( _attenuation && _scattered );
 
     const fv3 reflected = reflect(_ray.direction.get_normalized(), _hit.normal);
-    *_scattered = Ray(_hit.point, reflected + fuzziness * util::rand_point_in_unit_sphere());
+    *_scattered = Ray(_hit.point, reflected + fuzziness * util::rand_point_in_unit_sphere(_rng));
     *_attenuation = albedo;
     return (math::dot(_scattered->direction, _hit.normal) > 0.f);
 }
@@ -158,7 +158,7 @@ constexpr Dielectric::Dielectric(f32 _refractive_idx) noexcept
 {
 }
 
-inline b32 Dielectric::scatter(const Ray& _ray, const Hit& _hit, fv3* attenuation_, Ray* scattered_) const noexcept
+inline b32 Dielectric::scatter(const Ray& _ray, const Hit& _hit, Rng& _rng, fv3* attenuation_, Ray* scattered_) const noexcept
 {
     sws_assert(attenuation_ && scattered_);
 
@@ -189,7 +189,7 @@ inline b32 Dielectric::scatter(const Ray& _ray, const Hit& _hit, fv3* attenuatio
     const bool is_refracted = refract(_ray.direction, outward_normal, refractive_ratio, &refracted);
     const f32 reflection_probability = (is_refracted) ? schlick(cosine, refractive_idx) : 1.f;
 
-    const bool is_reflected = util::frand_01() < reflection_probability;
+    const bool is_reflected = util::frand_01(_rng) < reflection_probability;
     *scattered_ = Ray(_hit.point, (is_reflected) ? reflected : refracted);
 
     return true;
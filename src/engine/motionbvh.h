@@ -0,0 +1,427 @@
+// ======================================================================
+// File: motionbvh.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/bvh.h"
+#include "engine/hitable.h"
+#include "engine/ray.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <emmintrin.h>
+
+// Flattened BVH for moving primitives. Every node stores its bounds at both ends of its
+// time interval and hit() interpolates them at the ray's time: exact for the linear motion
+// of Transform and much tighter than the union box over the shutter, which inflates every
+// ancestor of a moving primitive. Nodes with large motion can split the time range instead,
+// a time-split node has one subtree per half interval, both over the same primitives.
+class MotionBVH : public Hitable
+{
+    NON_COPYABLE(MotionBVH);
+
+public:
+    struct alignas(64) Node
+    {
+        fv3 min0;
+        u32 offset;        // leaf: first primitive, interior and time split: second child
+        fv3 max0;
+        u16 nb_primitives; // 0 for interior and time-split nodes
+        u8 axis;           // interior: split axis, the first child is on its lower side
+        u8 is_time_split;  // the first child covers the first half of the interval, the second the rest
+        fv3 delta_min;     // bounds at the interval end minus bounds at its start
+        f32 t0;            // node interval start
+        fv3 delta_max;
+        union
+        {
+            f32 inv_duration; // 1 / interval length, 0 for an empty interval
+            f32 t_mid;        // time split: the instant the second child takes over
+        };
+    };
+    static_assert(sizeof(Node) == 64u && offsetof(Node, max0) == 16u && offsetof(Node, delta_min) == 32u && offsetof(Node, delta_max) == 48u);
+
+    static constexpr u32 k_stack_size = 64u; // traversal stack on the call stack, deeper trees use a heap one
+
+public:
+    inline MotionBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {});
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    // Same metric as BVH::get_sah_cost, with node areas taken mid-interval and time-split
+    // subtrees weighted by the share of the shutter they cover
+    inline f32 get_sah_cost(f32 _traversal_cost = BVHSettings {}.traversal_cost) const;
+
+    inline u32 get_nb_nodes() const;
+    inline u32 get_nb_time_splits() const;
+
+private:
+    struct Bounds
+    {
+        AABB start; // at the interval start
+        AABB end;   // at the interval end
+    };
+    using BoundsMap = std::unordered_map<const BVH*, Bounds>;
+
+    inline u32 build_interval(std::vector<Hitable*>& _hitables, f32 _t0, f32 _t1, u32 _nb_time_splits, u32 _depth, Bounds* bounds_);
+    inline u32 flatten_node(const Hitable* _hitable, const BoundsMap& _node_bounds, f32 _t0, f32 _t1, u32 _nb_time_splits, u32 _depth, Bounds* bounds_);
+    inline u32 add_leaf(const Hitable* const* _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, Bounds* bounds_);
+    inline u32 add_node(f32 _t0, f32 _t1);
+    inline b32 has_large_motion(const BVH& _node, const Bounds& _bounds) const;
+
+    static inline void set_bounds(Node* node_, const Bounds& _bounds);
+    static inline Bounds measure_bounds(const Hitable* _hitable, f32 _t0, f32 _t1, BoundsMap* node_bounds_);
+    static inline void collect(const Hitable* _hitable, std::vector<Hitable*>* hitables_);
+    static inline b32 is_hit(const Node& _node, const Ray& _ray, f32 _time, f32 _tmin, f32 _tmax);
+
+    inline f64 accumulate_sah_cost(u32 _node_idx, f64 _weight, f32 _traversal_cost) const;
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<Hitable*> m_primitives; // leaf order, time-split subtrees each keep their own copy
+    BVHSettings m_settings;
+    AABB m_aabb;
+    u32 m_nb_time_splits = 0u;
+    u32 m_depth = 0u; // levels of interior and time-split nodes, leaves included
+};
+
+inline MotionBVH::MotionBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+    : m_settings(_settings)
+{
+    if (_nb_hitables == 0u)
+        return;
+
+    std::vector<Hitable*> hitables(_hitables, _hitables + _nb_hitables);
+    Bounds bounds;
+    build_interval(hitables, _t0, _t1, _settings.max_time_splits, 1u, &bounds);
+
+    // The shutter union of every primitive, what the other layouts report as their root box
+    for (u32 idx = 0u; idx < _nb_hitables; ++idx)
+    {
+        AABB box;
+        _hitables[idx]->compute_aabb(_t0, _t1, &box);
+        m_aabb = (idx == 0u) ? box : AABB::get_surrounding_box(m_aabb, box);
+    }
+}
+
+inline u32 MotionBVH::build_interval(std::vector<Hitable*>& _hitables, f32 _t0, f32 _t1, u32 _nb_time_splits, u32 _depth, Bounds* bounds_)
+{
+    // The topology comes from the usual builders, on the union boxes of this interval only
+    const BVH bvh(_hitables.data(), u32(_hitables.size()), _t0, _t1, m_settings);
+    m_settings.build_stats = nullptr; // only the whole-shutter build is reported
+
+    // Bounds at both interval ends for every node, once and bottom-up, for the time-split test
+    BoundsMap node_bounds;
+    if (_nb_time_splits > 0u && _t1 > _t0)
+        measure_bounds(&bvh, _t0, _t1, &node_bounds);
+    return flatten_node(&bvh, node_bounds, _t0, _t1, _nb_time_splits, _depth, bounds_);
+}
+
+inline u32 MotionBVH::flatten_node(const Hitable* _hitable, const BoundsMap& _node_bounds, f32 _t0, f32 _t1, u32 _nb_time_splits, u32 _depth, Bounds* bounds_)
+{
+    m_depth = math::max(m_depth, _depth);
+
+    const BVH* node = dynamic_cast<const BVH*>(_hitable);
+    if (node && node->left == node->right)
+        return add_leaf(&node->left, 1u, _t0, _t1, bounds_);
+
+    if (node)
+    {
+        const auto bounds = _node_bounds.find(node);
+        if (bounds != _node_bounds.end() && has_large_motion(*node, bounds->second))
+        {
+            // Both halves rebuild over the same primitives, each with boxes for its own half
+            const f32 t_mid = 0.5f * (_t0 + _t1);
+            const u32 idx = add_node(_t0, _t1);
+            m_nodes[idx].is_time_split = 1u;
+            m_nodes[idx].t_mid = t_mid;
+            ++m_nb_time_splits;
+
+            std::vector<Hitable*> hitables;
+            collect(node, &hitables);
+            Bounds first, second;
+            build_interval(hitables, _t0, t_mid, _nb_time_splits - 1u, _depth + 1u, &first);
+            m_nodes[idx].offset = build_interval(hitables, t_mid, _t1, _nb_time_splits - 1u, _depth + 1u, &second);
+
+            // Linear motion: the boxes at both ends still bound the whole interval when interpolated
+            *bounds_ = { first.start, second.end };
+            set_bounds(&m_nodes[idx], *bounds_);
+            return idx;
+        }
+
+        const u32 idx = add_node(_t0, _t1);
+        m_nodes[idx].axis = node->split_axis;
+        Bounds left, right;
+        flatten_node(node->left, _node_bounds, _t0, _t1, _nb_time_splits, _depth + 1u, &left);
+        // Indices, not references: the vector grows while the children are added
+        m_nodes[idx].offset = flatten_node(node->right, _node_bounds, _t0, _t1, _nb_time_splits, _depth + 1u, &right);
+
+        *bounds_ = { AABB::get_surrounding_box(left.start, right.start), AABB::get_surrounding_box(left.end, right.end) };
+        set_bounds(&m_nodes[idx], *bounds_);
+        return idx;
+    }
+
+    if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+        return add_leaf(leaf->get_hitables().data(), leaf->get_size(), _t0, _t1, bounds_);
+
+    return add_leaf(&_hitable, 1u, _t0, _t1, bounds_);
+}
+
+inline u32 MotionBVH::add_leaf(const Hitable* const* _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, Bounds* bounds_)
+{
+    const u32 idx = add_node(_t0, _t1);
+    m_nodes[idx].offset = u32(m_primitives.size());
+    m_nodes[idx].nb_primitives = u16(_nb_hitables);
+    for (u32 primitive = 0u; primitive < _nb_hitables; ++primitive)
+    {
+        Bounds primitive_bounds;
+        _hitables[primitive]->compute_aabb(_t0, &primitive_bounds.start);
+        _hitables[primitive]->compute_aabb(_t1, &primitive_bounds.end);
+        *bounds_ = (primitive == 0u) ? primitive_bounds
+                                     : Bounds { AABB::get_surrounding_box(bounds_->start, primitive_bounds.start),
+                                                AABB::get_surrounding_box(bounds_->end, primitive_bounds.end) };
+        m_primitives.push_back(const_cast<Hitable*>(_hitables[primitive]));
+    }
+    set_bounds(&m_nodes[idx], *bounds_);
+    return idx;
+}
+
+inline u32 MotionBVH::add_node(f32 _t0, f32 _t1)
+{
+    const u32 idx = u32(m_nodes.size());
+    Node& node = m_nodes.emplace_back();
+    node.offset = 0u;
+    node.nb_primitives = 0u;
+    node.axis = 0u;
+    node.is_time_split = 0u;
+    node.t0 = _t0;
+    node.inv_duration = (_t1 > _t0) ? math::inv(_t1 - _t0) : 0.f;
+    return idx;
+}
+
+inline b32 MotionBVH::has_large_motion(const BVH& _node, const Bounds& _bounds) const
+{
+    // The shutter union against the box interpolated halfway: a ratio near 1 means little motion
+    const AABB mid(0.5f * (_bounds.start.min + _bounds.end.min), 0.5f * (_bounds.start.max + _bounds.end.max));
+    return _node.aabb.get_surface_area() > m_settings.time_split_ratio * mid.get_surface_area();
+}
+
+inline void MotionBVH::set_bounds(Node* node_, const Bounds& _bounds)
+{
+    node_->min0 = _bounds.start.min;
+    node_->max0 = _bounds.start.max;
+    node_->delta_min = _bounds.end.min - _bounds.start.min;
+    node_->delta_max = _bounds.end.max - _bounds.start.max;
+}
+
+inline MotionBVH::Bounds MotionBVH::measure_bounds(const Hitable* _hitable, f32 _t0, f32 _t1, BoundsMap* node_bounds_)
+{
+    Bounds bounds;
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        bounds = measure_bounds(node->left, _t0, _t1, node_bounds_);
+        if (node->right != node->left)
+        {
+            const Bounds right = measure_bounds(node->right, _t0, _t1, node_bounds_);
+            bounds = { AABB::get_surrounding_box(bounds.start, right.start), AABB::get_surrounding_box(bounds.end, right.end) };
+        }
+        (*node_bounds_)[node] = bounds;
+    }
+    else if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+    {
+        for (u32 idx = 0u; idx < leaf->get_size(); ++idx)
+        {
+            Bounds primitive_bounds;
+            leaf->get_hitables()[idx]->compute_aabb(_t0, &primitive_bounds.start);
+            leaf->get_hitables()[idx]->compute_aabb(_t1, &primitive_bounds.end);
+            bounds = (idx == 0u) ? primitive_bounds
+                                 : Bounds { AABB::get_surrounding_box(bounds.start, primitive_bounds.start),
+                                            AABB::get_surrounding_box(bounds.end, primitive_bounds.end) };
+        }
+    }
+    else
+    {
+        _hitable->compute_aabb(_t0, &bounds.start);
+        _hitable->compute_aabb(_t1, &bounds.end);
+    }
+    return bounds;
+}
+
+inline void MotionBVH::collect(const Hitable* _hitable, std::vector<Hitable*>* hitables_)
+{
+    if (const BVH* node = dynamic_cast<const BVH*>(_hitable))
+    {
+        collect(node->left, hitables_);
+        if (node->right != node->left)
+            collect(node->right, hitables_);
+    }
+    else if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(_hitable))
+        hitables_->insert(hitables_->end(), leaf->get_hitables().begin(), leaf->get_hitables().end());
+    else
+        hitables_->push_back(const_cast<Hitable*>(_hitable));
+}
+
+inline b32 MotionBVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    u32 local_stack[k_stack_size];
+    std::vector<u32> heap_stack((m_depth > k_stack_size) ? m_depth : 0u);
+    u32* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    u32 node_idx = 0u;
+    b32 has_hit_anything = false;
+    f32 closest_dist = _zmax;
+    u32 nb_visits = 0u;
+    for (;;)
+    {
+        const Node& node = m_nodes[node_idx];
+        ++nb_visits;
+        if (node.is_time_split)
+        {
+            node_idx = (_time < node.t_mid) ? node_idx + 1u : node.offset;
+            continue;
+        }
+
+        if (is_hit(node, _ray, _time, _zmin, closest_dist))
+        {
+            if (node.nb_primitives == 0u)
+            {
+                const b32 is_second_near = (m_settings.traversal == BVHTraversal::Ordered) && _ray.sign[node.axis];
+                stack[stack_size++] = is_second_near ? node_idx + 1u : node.offset;
+                node_idx = is_second_near ? node.offset : node_idx + 1u;
+                continue;
+            }
+
+            for (u32 idx = node.offset; idx < node.offset + node.nb_primitives; ++idx)
+            {
+                Hit tmp_hit;
+                if (m_primitives[idx]->hit(_ray, _time, _zmin, closest_dist, &tmp_hit))
+                {
+                    has_hit_anything = true;
+                    closest_dist = tmp_hit.distance;
+                    *hit_ = std::move(tmp_hit);
+                }
+            }
+        }
+
+        if (stack_size == 0u)
+            break;
+        node_idx = stack[--stack_size];
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return has_hit_anything;
+}
+
+inline b32 MotionBVH::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    u32 local_stack[k_stack_size];
+    std::vector<u32> heap_stack((m_depth > k_stack_size) ? m_depth : 0u);
+    u32* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    u32 node_idx = 0u;
+    u32 nb_visits = 0u;
+    b32 is_occluded = false;
+    for (;;)
+    {
+        const Node& node = m_nodes[node_idx];
+        ++nb_visits;
+        if (node.is_time_split)
+        {
+            node_idx = (_time < node.t_mid) ? node_idx + 1u : node.offset;
+            continue;
+        }
+
+        if (is_hit(node, _ray, _time, _zmin, _zmax))
+        {
+            if (node.nb_primitives == 0u)
+            {
+                stack[stack_size++] = node.offset;
+                node_idx = node_idx + 1u;
+                continue;
+            }
+
+            for (u32 idx = node.offset; idx < node.offset + node.nb_primitives && !is_occluded; ++idx)
+                is_occluded = m_primitives[idx]->occluded(_ray, _time, _zmin, _zmax);
+            if (is_occluded)
+                break;
+        }
+
+        if (stack_size == 0u)
+            break;
+        node_idx = stack[--stack_size];
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return is_occluded;
+}
+
+inline b32 MotionBVH::is_hit(const Node& _node, const Ray& _ray, f32 _time, f32 _tmin, f32 _tmax)
+{
+    // Fourth lanes of min0/max0 hold the offset and counts, zeroed as in LinearBVH::is_hit;
+    // those of the deltas are the interval, plain floats whose result lane is never read
+    const __m128 xyz_mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 s = _mm_set1_ps(math::min(math::max((_time - _node.t0) * _node.inv_duration, 0.f), 1.f));
+    const __m128 min = _mm_add_ps(_mm_and_ps(_mm_load_ps(&_node.min0.x), xyz_mask), _mm_mul_ps(s, _mm_load_ps(&_node.delta_min.x)));
+    const __m128 max = _mm_add_ps(_mm_and_ps(_mm_load_ps(&_node.max0.x), xyz_mask), _mm_mul_ps(s, _mm_load_ps(&_node.delta_max.x)));
+    return AABB::is_hit(min, max, _ray, _tmin, _tmax);
+}
+
+inline b32 MotionBVH::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return compute_aabb(_time, _time, aabb_);
+}
+
+inline b32 MotionBVH::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    if (m_nodes.empty())
+        return false;
+    *aabb_ = m_aabb;
+    return true;
+}
+
+inline f32 MotionBVH::get_sah_cost(f32 _traversal_cost) const
+{
+    const f32 root_area = m_aabb.get_surface_area();
+    if (m_nodes.empty() || root_area <= 0.f)
+        return 0.f;
+    return f32(accumulate_sah_cost(0u, 1., _traversal_cost) / root_area);
+}
+
+inline f64 MotionBVH::accumulate_sah_cost(u32 _node_idx, f64 _weight, f32 _traversal_cost) const
+{
+    const Node& node = m_nodes[_node_idx];
+    if (node.is_time_split)
+        return accumulate_sah_cost(_node_idx + 1u, 0.5 * _weight, _traversal_cost) + accumulate_sah_cost(node.offset, 0.5 * _weight, _traversal_cost);
+
+    const AABB mid(node.min0 + 0.5f * node.delta_min, node.max0 + 0.5f * node.delta_max);
+    const f64 cost = _weight * mid.get_surface_area() * ((node.nb_primitives == 0u) ? _traversal_cost : f32(node.nb_primitives));
+    if (node.nb_primitives > 0u)
+        return cost;
+    return cost + accumulate_sah_cost(_node_idx + 1u, _weight, _traversal_cost) + accumulate_sah_cost(node.offset, _weight, _traversal_cost);
+}
+
+inline u32 MotionBVH::get_nb_nodes() const
+{
+    return u32(m_nodes.size());
+}
+
+inline u32 MotionBVH::get_nb_time_splits() const
+{
+    return m_nb_time_splits;
+}
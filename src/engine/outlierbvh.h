@@ -0,0 +1,205 @@
+// ======================================================================
+// File: outlierbvh.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/hitable.h"
+#include "engine/ray.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// A BVH over the ordinary primitives and a short list of the others, tested one by one
+// before it: primitives without a box (Plane) and the few whose box dwarfs everything else,
+// like the random scene's 1000-radius ground sphere. Inside the tree such a box becomes the
+// root's and every split below it has to separate primitives that all sit in a sliver of it.
+// Testing them first also shrinks the range the tree is traced over.
+class OutlierBVH : public Hitable
+{
+    NON_COPYABLE(OutlierBVH);
+
+public:
+    static constexpr u32 k_max_outliers = 8u; // bounded ones, unbounded primitives always go to the list
+
+    // Owns _bvh, not the outliers. _bvh is null when every primitive is an outlier
+    inline OutlierBVH(Hitable* _bvh, std::vector<Hitable*>&& _outliers);
+    virtual inline ~OutlierBVH();
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline void occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const override;
+    // False with an unbounded outlier
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    inline Hitable* get_bvh() const;
+    inline const std::vector<Hitable*>& get_outliers() const;
+
+    // Keeps _hitables' order in both lists. A bounded primitive is an outlier when its box has
+    // over _area_ratio times the area of the box around every primitive smaller than it, tried
+    // from the largest down; 0 leaves only the unbounded ones out.
+    static inline void split(Hitable* const* _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, f32 _area_ratio,
+                             std::vector<Hitable*>* inliers_, std::vector<Hitable*>* outliers_);
+
+    // _build_fn(hitables, count) builds the tree, over the inliers when there are outliers
+    template <typename BuildFn>
+    static inline Hitable* create(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, f32 _area_ratio, BuildFn&& _build_fn);
+
+private:
+    Hitable* m_bvh = nullptr;
+    std::vector<Hitable*> m_outliers;
+};
+
+inline OutlierBVH::OutlierBVH(Hitable* _bvh, std::vector<Hitable*>&& _outliers)
+    : m_bvh(_bvh)
+    , m_outliers(std::move(_outliers))
+{
+}
+
+inline OutlierBVH::~OutlierBVH()
+{
+    util::safe_del(m_bvh);
+}
+
+inline b32 OutlierBVH::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    b32 has_hit_anything = false;
+    f32 closest_dist = _zmax;
+    for (const Hitable* outlier : m_outliers)
+    {
+        Hit tmp_hit;
+        if (outlier->hit(_ray, _time, _zmin, closest_dist, &tmp_hit))
+        {
+            has_hit_anything = true;
+            closest_dist = tmp_hit.distance;
+            *hit_ = std::move(tmp_hit);
+        }
+    }
+
+    Hit tmp_hit;
+    if (m_bvh && m_bvh->hit(_ray, _time, _zmin, closest_dist, &tmp_hit))
+    {
+        *hit_ = std::move(tmp_hit);
+        return true;
+    }
+    return has_hit_anything;
+}
+
+inline b32 OutlierBVH::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    for (const Hitable* outlier : m_outliers)
+    {
+        if (outlier->occluded(_ray, _time, _zmin, _zmax))
+            return true;
+    }
+    return m_bvh && m_bvh->occluded(_ray, _time, _zmin, _zmax);
+}
+
+inline void OutlierBVH::occluded(const OcclusionQuery* _queries, u32 _nb_queries, b32* occluded_) const
+{
+    // The batch stays whole for the tree, the outliers only see the rays it let through
+    if (m_bvh)
+        m_bvh->occluded(_queries, _nb_queries, occluded_);
+    else
+        std::fill(occluded_, occluded_ + _nb_queries, false);
+    for (u32 idx = 0u; idx < _nb_queries; ++idx)
+    {
+        const OcclusionQuery& query = _queries[idx];
+        for (u32 outlier = 0u; outlier < m_outliers.size() && !occluded_[idx]; ++outlier)
+            occluded_[idx] = m_outliers[outlier]->occluded(query.ray, query.time, query.zmin, query.zmax);
+    }
+}
+
+inline b32 OutlierBVH::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return compute_aabb(_time, _time, aabb_);
+}
+
+inline b32 OutlierBVH::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    AABB bounds;
+    if (m_bvh && !m_bvh->compute_aabb(_t0, _t1, &bounds))
+        return false;
+    for (usize idx = 0u; idx < m_outliers.size(); ++idx)
+    {
+        AABB outlier_bounds;
+        if (!m_outliers[idx]->compute_aabb(_t0, _t1, &outlier_bounds))
+            return false;
+        bounds = (idx == 0u && !m_bvh) ? outlier_bounds : AABB::get_surrounding_box(bounds, outlier_bounds);
+    }
+    *aabb_ = bounds;
+    return true;
+}
+
+inline Hitable* OutlierBVH::get_bvh() const
+{
+    return m_bvh;
+}
+
+inline const std::vector<Hitable*>& OutlierBVH::get_outliers() const
+{
+    return m_outliers;
+}
+
+inline void OutlierBVH::split(Hitable* const* _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, f32 _area_ratio,
+                              std::vector<Hitable*>* inliers_, std::vector<Hitable*>* outliers_)
+{
+    struct Candidate
+    {
+        f32 area;
+        u32 idx;
+        AABB bounds;
+    };
+
+    std::vector<b32> is_outlier(_nb_hitables, false);
+    std::vector<Candidate> candidates;
+    candidates.reserve(_nb_hitables);
+    for (u32 idx = 0u; idx < _nb_hitables; ++idx)
+    {
+        AABB bounds;
+        if (_hitables[idx]->compute_aabb(_t0, _t1, &bounds))
+            candidates.push_back({ bounds.get_surface_area(), idx, bounds });
+        else
+            is_outlier[idx] = true;
+    }
+
+    // The largest few, each against the box around every bounded primitive smaller than it
+    const u32 nb_largest = u32(math::min(usize(k_max_outliers), candidates.size()));
+    if (_area_ratio > 0.f && nb_largest > 0u && nb_largest < candidates.size())
+    {
+        std::partial_sort(candidates.begin(), candidates.begin() + nb_largest, candidates.end(),
+                          [](const Candidate& _a, const Candidate& _b) { return _a.area > _b.area || (_a.area == _b.area && _a.idx < _b.idx); });
+
+        std::vector<AABB> smaller_bounds(nb_largest + 1u);
+        smaller_bounds[nb_largest] = candidates[nb_largest].bounds;
+        for (usize rank = nb_largest + 1u; rank < candidates.size(); ++rank)
+            smaller_bounds[nb_largest] = AABB::get_surrounding_box(smaller_bounds[nb_largest], candidates[rank].bounds);
+        for (u32 rank = nb_largest; rank-- > 1u;)
+            smaller_bounds[rank] = AABB::get_surrounding_box(smaller_bounds[rank + 1u], candidates[rank].bounds);
+
+        for (u32 rank = 0u; rank < nb_largest && candidates[rank].area > _area_ratio * smaller_bounds[rank + 1u].get_surface_area(); ++rank)
+            is_outlier[candidates[rank].idx] = true;
+    }
+
+    for (u32 idx = 0u; idx < _nb_hitables; ++idx)
+        (is_outlier[idx] ? outliers_ : inliers_)->push_back(_hitables[idx]);
+}
+
+template <typename BuildFn>
+inline Hitable* OutlierBVH::create(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, f32 _area_ratio, BuildFn&& _build_fn)
+{
+    std::vector<Hitable*> inliers;
+    std::vector<Hitable*> outliers;
+    split(_hitables, _nb_hitables, _t0, _t1, _area_ratio, &inliers, &outliers);
+    if (outliers.empty())
+        return _build_fn(_hitables, _nb_hitables);
+    return new OutlierBVH(inliers.empty() ? nullptr : _build_fn(inliers.data(), u32(inliers.size())), std::move(outliers));
+}
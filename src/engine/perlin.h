@@ -18,11 +18,12 @@ private:
     static constexpr usize k_perm_size = 256u;
     static constexpr usize k_perm_mask = k_perm_size - 1u;
     static constexpr usize k_cube_size = 2u;
+    static constexpr u64 k_seed = 0x2545f4914f6cdd1dull; // fixed tables, noise must not change between runs
     
     static constexpr f32 trilerp(fv3 (&_c)[k_cube_size][k_cube_size][k_cube_size], f32 _u, f32 _v, f32 _w);
     static constexpr f32 fade(f32 _t);
 
-    static constexpr void permute(std::array<sv3, k_perm_size>& _arr);
+    static inline void permute(std::array<sv3, k_perm_size>& _arr, Rng& _rng);
     static inline std::array<sv3, k_perm_size> generate_permutations();
     static inline std::array<fv3, k_perm_size> generate_rand_vectors();
 
@@ -120,13 +121,13 @@ inline constexpr f32 Perlin::fade(f32 _t)
     return _t*_t*_t*(_t*(_t*6.f-15.f)+10.f); // Improved fade
 }
 
-constexpr void Perlin::permute(std::array<sv3, k_perm_size>& _arr)
+inline void Perlin::permute(std::array<sv3, k_perm_size>& _arr, Rng& _rng)
 {
     for (usize i = k_perm_size-1; i > 0; --i)
     {
-        const s32 target_x = s32(util::drand_01()*(i+1));
-        const s32 target_y = s32(util::drand_01()*(i+1));
-        const s32 target_z = s32(util::drand_01()*(i+1));
+        const s32 target_x = s32(util::drand_01(_rng)*(i+1));
+        const s32 target_y = s32(util::drand_01(_rng)*(i+1));
+        const s32 target_z = s32(util::drand_01(_rng)*(i+1));
         std::swap(_arr[i].x, _arr[target_x].x);
         std::swap(_arr[i].y, _arr[target_y].y);
         std::swap(_arr[i].z, _arr[target_z].z);
@@ -138,15 +139,22 @@ inline std::array<sv3, Perlin::k_perm_size> Perlin::generate_permutations()
     std::array<sv3, k_perm_size> arr;
     for (s32 i = 0; i < k_perm_size; ++i)
         arr[i].set(i);
-    permute(arr);
+    Rng rng(k_seed, 0u);
+    permute(arr, rng);
     return std::move(arr);
 }
 
 inline std::array<fv3, Perlin::k_perm_size> Perlin::generate_rand_vectors()
 {
     std::array<fv3, k_perm_size> gradients;
-    const auto rand_range = []() constexpr { return 2.f*util::frand_01() - 1.f; };
+    Rng rng(k_seed, 1u);
+    const auto rand_range = [&rng]() { return 2.f*util::frand_01(rng) - 1.f; };
     for (usize i = 0; i < k_perm_size; ++i)
-        gradients[i] = fv3(rand_range(), rand_range(), rand_range()).get_normalized();
+    {
+        const f32 x = rand_range();
+        const f32 y = rand_range();
+        const f32 z = rand_range();
+        gradients[i] = fv3(x, y, z).get_normalized();
+    }
     return std::move(gradients);
 }
@@ -0,0 +1,98 @@
+// ======================================================================
+// File: plane.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/math/aabb.h"
+
+#include "engine/ray.h"
+#include "engine/entity.h"
+
+// Infinite plane through the transform's position. It has no bounding box, so a BVH keeps it
+// in its outlier list (engine/outlierbvh.h). The normal is the outward side for materials,
+// uv repeats every unit along two axes in the plane.
+class Plane : public Entity
+{
+    MOVABLE_ONLY(Plane);
+
+public:
+    inline Plane(Transform&& _tf, const fv3& _normal, Material* _mat);
+    ~Plane() override = default;
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Entity::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+
+    // Unbounded: false, aabb_ is left as is
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+private:
+    inline b32 find_distance(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, f32* distance_) const;
+
+private:
+    fv3 normal;
+    fv3 tangent;   // uv axes, orthonormal with the normal
+    fv3 bitangent;
+};
+
+inline Plane::Plane(Transform&& _tf, const fv3& _normal, Material* _mat)
+    : Entity(std::move(_tf), _mat)
+    , normal(_normal.get_normalized())
+{
+    // Any axis far enough from the normal gives a stable tangent
+    const fv3 axis = (math::abs(normal.x) < 0.9f) ? fv3(1.f, 0.f, 0.f) : fv3(0.f, 1.f, 0.f);
+    tangent = math::cross(axis, normal).get_normalized();
+    bitangent = math::cross(normal, tangent);
+}
+
+inline b32 Plane::find_distance(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, f32* distance_) const
+{
+    // dot(p(t) - P, N) = 0  =>  t = dot(P - A, N) / dot(B, N)
+    const f32 cos_angle = math::dot(_ray.direction, normal);
+    if (cos_angle == 0.f)
+        return false;
+
+    const f32 distance = math::dot(transform.get_position(_time) - _ray.origin, normal) / cos_angle;
+    if (distance <= _zmin || distance >= _zmax)
+        return false;
+    *distance_ = distance;
+    return true;
+}
+
+inline b32 Plane::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    sws_assert(hit_);
+
+    f32 distance;
+    if (!find_distance(_ray, _time, _zmin, _zmax, &distance))
+        return false;
+
+    hit_->distance = distance;
+    hit_->point    = _ray.point_at(distance);
+    hit_->normal   = normal;
+    hit_->material = material;
+    const fv3 offset = hit_->point - transform.get_position(_time);
+    hit_->uv       = fv2(math::frac(math::dot(offset, tangent)), math::frac(math::dot(offset, bitangent)));
+    return true;
+}
+
+inline b32 Plane::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    f32 distance;
+    return find_distance(_ray, _time, _zmin, _zmax, &distance);
+}
+
+inline b32 Plane::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    return false;
+}
+
+inline b32 Plane::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    return false;
+}
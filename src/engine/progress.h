@@ -0,0 +1,157 @@
+// ======================================================================
+// File: progress.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct ProgressSnapshot
+{
+    constexpr f64 get_ratio() const;
+
+    u64 nb_pixels       = 0u;
+    u64 nb_total_pixels = 0u;
+    u64 nb_samples      = 0u;
+    u64 nb_rays         = 0u;
+    f64 elapsed_seconds = 0.;
+    f64 rays_per_second = 0.;
+    f64 eta_seconds     = 0.;
+};
+
+// Counters bumped by the render workers with relaxed atomics, no lock is taken on
+// the hot path. Readers (the reporter thread or an embedding application) get a
+// consistent-enough snapshot at any time through get_snapshot().
+class RenderProgress
+{
+    NON_COPYABLE(RenderProgress);
+
+public:
+    RenderProgress() = default;
+
+    inline void begin(u64 _nb_total_pixels);
+    inline void add(u64 _nb_pixels, u64 _nb_samples, u64 _nb_rays);
+
+    inline ProgressSnapshot get_snapshot() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Each counter on its own cache line, workers on different cores do not fight over them
+    alignas(64) std::atomic<u64> m_nb_pixels  = 0u;
+    alignas(64) std::atomic<u64> m_nb_samples = 0u;
+    alignas(64) std::atomic<u64> m_nb_rays    = 0u;
+    alignas(64) std::atomic<u64> m_nb_total_pixels = 0u;
+    std::atomic<s64> m_start_ns = 0;
+};
+
+// Prints throttled progress lines from its own thread until destroyed.
+class ProgressReporter
+{
+    NON_COPYABLE(ProgressReporter);
+
+public:
+    inline ProgressReporter(const RenderProgress& _progress, u32 _interval_ms);
+    inline ~ProgressReporter();
+
+    static inline void print(const ProgressSnapshot& _snapshot);
+
+private:
+    inline void reporter_loop();
+
+private:
+    const RenderProgress& m_progress;
+    std::chrono::milliseconds m_interval;
+    std::mutex m_mutex;
+    std::condition_variable m_stop_cv;
+    std::thread m_thread;
+    b32 m_stop = false;
+};
+
+// ProgressSnapshot //
+
+constexpr f64 ProgressSnapshot::get_ratio() const
+{
+    return (nb_total_pixels > 0u) ? f64(nb_pixels) / f64(nb_total_pixels) : 0.;
+}
+
+// RenderProgress //
+
+inline void RenderProgress::begin(u64 _nb_total_pixels)
+{
+    m_nb_pixels.store(0u, std::memory_order_relaxed);
+    m_nb_samples.store(0u, std::memory_order_relaxed);
+    m_nb_rays.store(0u, std::memory_order_relaxed);
+    m_nb_total_pixels.store(_nb_total_pixels, std::memory_order_relaxed);
+    m_start_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count(),
+                     std::memory_order_relaxed);
+}
+
+inline void RenderProgress::add(u64 _nb_pixels, u64 _nb_samples, u64 _nb_rays)
+{
+    m_nb_pixels.fetch_add(_nb_pixels, std::memory_order_relaxed);
+    m_nb_samples.fetch_add(_nb_samples, std::memory_order_relaxed);
+    m_nb_rays.fetch_add(_nb_rays, std::memory_order_relaxed);
+}
+
+inline ProgressSnapshot RenderProgress::get_snapshot() const
+{
+    ProgressSnapshot snapshot;
+    snapshot.nb_pixels       = m_nb_pixels.load(std::memory_order_relaxed);
+    snapshot.nb_total_pixels = m_nb_total_pixels.load(std::memory_order_relaxed);
+    snapshot.nb_samples      = m_nb_samples.load(std::memory_order_relaxed);
+    snapshot.nb_rays         = m_nb_rays.load(std::memory_order_relaxed);
+
+    const s64 now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    snapshot.elapsed_seconds = f64(now_ns - m_start_ns.load(std::memory_order_relaxed)) / 1e9;
+    if (snapshot.elapsed_seconds > 0.)
+        snapshot.rays_per_second = f64(snapshot.nb_rays) / snapshot.elapsed_seconds;
+
+    const f64 ratio = snapshot.get_ratio();
+    if (ratio > 0.)
+        snapshot.eta_seconds = snapshot.elapsed_seconds * (1. - ratio) / ratio;
+
+    return snapshot;
+}
+
+// ProgressReporter //
+
+inline ProgressReporter::ProgressReporter(const RenderProgress& _progress, u32 _interval_ms)
+    : m_progress(_progress)
+    , m_interval(_interval_ms)
+{
+    m_thread = std::thread(&ProgressReporter::reporter_loop, this);
+}
+
+inline ProgressReporter::~ProgressReporter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_stop_cv.notify_one();
+    m_thread.join();
+}
+
+inline void ProgressReporter::print(const ProgressSnapshot& _snapshot)
+{
+    util::output_to_console("%6.2f%% completed | %.2f Mrays/s | elapsed %.1fs | ETA %.1fs",
+                            100. * _snapshot.get_ratio(), _snapshot.rays_per_second / 1e6,
+                            _snapshot.elapsed_seconds, _snapshot.eta_seconds);
+}
+
+inline void ProgressReporter::reporter_loop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop_cv.wait_for(lock, m_interval, [this]() { return m_stop; }))
+        print(m_progress.get_snapshot());
+}
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <core/math/math.h>
 #include <core/math/v3.h>
 
 class Ray
@@ -22,18 +23,51 @@ public:
 public:
     fv3 origin;
     fv3 direction;
+
+    // Slab test terms, computed once per ray: t = (bound - slab_origin) * inv_direction. The
+    // reciprocal is clamped to +-k_max_inv_direction, so a zero component never gives
+    // inf * 0 = NaN. Both are one 16-byte vector with a zero lane 3: a load never picks up a
+    // neighbouring member, whose bits could be a denormal that slows every box test down.
+    alignas(16) f32 slab_origin[4];
+    alignas(16) f32 inv_direction[4];
+    u32 sign[3]; // 1 where the direction is negative: index of the near plane in { min, max }
+
+    static constexpr f32 k_max_inv_direction = 1e30f;
+
+private:
+    constexpr void compute_slab_terms() noexcept;
 };
 
 constexpr Ray::Ray() noexcept
     : origin(0.f)
     , direction(0.f)
+    , slab_origin{ 0.f, 0.f, 0.f, 0.f }
+    , inv_direction{ 0.f, 0.f, 0.f, 0.f }
+    , sign{ 0u, 0u, 0u }
 {
+    compute_slab_terms();
 }
 
 constexpr Ray::Ray(const fv3& origin, const fv3& direction) noexcept
     : origin(origin)
     , direction(direction.get_normalized())
+    , slab_origin{ 0.f, 0.f, 0.f, 0.f }
+    , inv_direction{ 0.f, 0.f, 0.f, 0.f }
+    , sign{ 0u, 0u, 0u }
+{
+    compute_slab_terms();
+}
+
+constexpr void Ray::compute_slab_terms() noexcept
 {
+    for (usize i = 0u; i < 3u; ++i)
+    {
+        // -0 gives -inf, clamped to -k_max_inv_direction with its sign kept
+        const f32 inv = math::min(math::max(math::inv(direction[i]), -k_max_inv_direction), k_max_inv_direction);
+        slab_origin[i] = origin[i];
+        inv_direction[i] = inv;
+        sign[i] = (inv < 0.f) ? 1u : 0u;
+    }
 }
 
 constexpr fv3 Ray::point_at(f32 distance) const noexcept
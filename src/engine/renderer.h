@@ -0,0 +1,574 @@
+// ======================================================================
+// File: renderer.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/math/curves.h"
+#include "core/perfcounters.h"
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "core/utils.h"
+
+#include "engine/camera.h"
+#include "engine/framebuffer.h"
+#include "engine/hitable.h"
+#include "engine/material.h"
+#include "engine/progress.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Order in which tiles are handed out. Space-filling curves keep consecutive tiles
+// (and the BVH nodes/texels they touch) next to each other.
+enum class TileOrder { Scanline, Morton, Hilbert };
+
+// Order in which the pixels of a tile are traced.
+enum class PixelOrder { Scanline, Morton };
+
+inline const utf8* get_name(TileOrder _order);
+inline const utf8* get_name(PixelOrder _order);
+inline b32 parse_tile_order(const std::string& _name, TileOrder* order_);
+inline b32 parse_pixel_order(const std::string& _name, PixelOrder* order_);
+
+struct RenderSettings
+{
+    u32 width      = 600u;
+    u32 height     = 480u;
+    u32 nb_samples = 30u;
+    u32 tile_size  = 16u;
+    s32 max_depth  = 50;
+    u64 seed       = 0x5eed5eedull;
+    u32 progress_interval_ms = 1000u; // 0 disables the progress reporter
+    TileOrder tile_order   = TileOrder::Scanline;
+    PixelOrder pixel_order = PixelOrder::Scanline;
+    b32 use_perf_counters  = false; // L1D/LLC misses of the workers, where the platform exposes them
+    f64 time_budget_seconds = 0.;   // > 0: progressive passes until the deadline, nb_samples is ignored
+    u32 samples_per_pass    = 1u;
+};
+
+// Identifies one camera sample. Every random decision taken while tracing it is
+// drawn from a generator keyed by (seed, pixel, sample, bounce), which makes the
+// image independent from the number of threads and the order tiles are processed.
+struct SampleId
+{
+    constexpr Rng get_rng(u32 _bounce) const { return Rng::from_sample(seed, pixel, sample, _bounce); }
+
+    u64 seed;
+    u32 pixel;
+    u32 sample;
+};
+
+struct Tile
+{
+    u32 x0, y0; // inclusive
+    u32 x1, y1; // exclusive
+};
+
+struct RenderStats
+{
+    inline void print() const;
+
+    f64 seconds = 0.;
+    u32 nb_tiles = 0u;
+    u64 nb_rays = 0u;
+    std::vector<ThreadPool::WorkerStats> workers;
+    PerfCounters::Values cache;
+    u32 nb_samples = 0u; // per pixel, as reached in time-budgeted mode
+    u32 nb_passes  = 0u; // 0 when rendered in a single pass
+};
+
+// Splits the frame into tiles and traces them on a work-stealing thread pool.
+// Tiles are dealt out in contiguous bands, one per NUMA node of the pool; with a
+// pinned pool each band of the framebuffer is first-touched by its node's workers
+// and, when one world replica per node is given, tiles trace the local replica.
+// With a time budget the frame is refined by whole-frame passes instead, so the
+// image is complete, only noisier, whenever the deadline stops it.
+class Renderer
+{
+    NON_COPYABLE(Renderer);
+
+public:
+    inline Renderer(ThreadPool& _pool, const RenderSettings& _settings);
+
+    inline RenderStats render(const Camera& _camera, const Hitable* _world, Framebuffer* framebuffer_);
+    inline RenderStats render(const Camera& _camera, const std::vector<const Hitable*>& _node_worlds, Framebuffer* framebuffer_);
+
+    // Traces one tile without touching a framebuffer: averaged linear colors, row-major
+    // from the tile's top row. to_rgb() turns them into the exact bytes render() writes.
+    inline u64 trace_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, fv3* colors_) const;
+    static inline rgb to_rgb(const fv3& _linear_color);
+
+    inline std::vector<Tile> generate_tiles() const;
+
+    inline const RenderSettings& get_settings() const;
+    inline const RenderProgress& get_progress() const;
+
+private:
+    inline std::vector<u32> assign_tiles(u32 _nb_tiles) const;
+    inline void render_passes(const std::vector<Tile>& _tiles, const std::vector<u32>& _owners, const Camera& _camera,
+                              const std::vector<const Hitable*>& _node_worlds, Framebuffer* framebuffer_, RenderStats* stats_);
+
+    template<typename Fn>
+    inline void for_each_pixel(const Tile& _tile, Fn&& _fn) const;
+    inline fv3 trace_sample(const Camera& _camera, const Hitable* _world, u32 _x, u32 _y, u32 _sample, f32 _sx, f32 _sy, f32 _time, u64* nb_rays_) const;
+    inline fv3 trace_pixel(const Camera& _camera, const Hitable* _world, u32 _x, u32 _y, u64* nb_rays_) const;
+    inline void render_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, Framebuffer* framebuffer_) const;
+    inline void accumulate_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, u32 _first_sample, u32 _nb_samples, fv3* accumulation_) const;
+    inline const Hitable* get_local_world(const std::vector<const Hitable*>& _node_worlds) const;
+
+    static constexpr fv3 background_color(const Ray& _ray);
+    static inline fv3 generate_color(const Ray& _ray, const Hitable* _world, f32 _time, const SampleId& _sample, s32 _depth, s32 _max_depth, u64* nb_rays_);
+    static inline fv3 correct_gamma(const fv3& _color);
+
+private:
+    ThreadPool& m_pool;
+    RenderSettings m_settings;
+    mutable RenderProgress m_progress;
+
+    static constexpr f64 k_deadline_margin = 1.1; // a pass only starts if 110% of the slowest one still fits
+};
+
+inline const utf8* get_name(TileOrder _order)
+{
+    switch (_order)
+    {
+        case TileOrder::Morton:  return "morton";
+        case TileOrder::Hilbert: return "hilbert";
+        default:                 return "scanline";
+    }
+}
+
+inline const utf8* get_name(PixelOrder _order)
+{
+    return (_order == PixelOrder::Morton) ? "morton" : "scanline";
+}
+
+inline b32 parse_tile_order(const std::string& _name, TileOrder* order_)
+{
+    for (const TileOrder order : { TileOrder::Scanline, TileOrder::Morton, TileOrder::Hilbert })
+    {
+        if (_name == get_name(order))
+        {
+            *order_ = order;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline b32 parse_pixel_order(const std::string& _name, PixelOrder* order_)
+{
+    for (const PixelOrder order : { PixelOrder::Scanline, PixelOrder::Morton })
+    {
+        if (_name == get_name(order))
+        {
+            *order_ = order;
+            return true;
+        }
+    }
+    return false;
+}
+
+// RenderStats //
+
+inline void RenderStats::print() const
+{
+    u64 total_busy_ns = 0u;
+    u64 total_stolen = 0u;
+    for (usize idx = 0u; idx < workers.size(); ++idx)
+    {
+        const ThreadPool::WorkerStats& ws = workers[idx];
+        const f64 busy_s = f64(ws.busy_ns) / 1e9;
+        const f64 idle_s = math::max(seconds - busy_s, 0.);
+        util::output_to_console("  thread %2zu: busy %.3fs idle %.3fs (%5.1f%%) tiles %llu stolen %llu",
+                                idx, busy_s, idle_s, (seconds > 0.) ? 100. * busy_s / seconds : 0.,
+                                ws.nb_jobs, ws.nb_stolen);
+        total_busy_ns += ws.busy_ns;
+        total_stolen += ws.nb_stolen;
+    }
+
+    const f64 efficiency = (seconds > 0. && !workers.empty()) ? (f64(total_busy_ns) / 1e9) / (seconds * workers.size()) : 0.;
+    util::output_to_console("Rendered %u tiles in %.3fs on %zu threads (efficiency %.1f%%, %llu tiles stolen, %.2f Mrays/s)",
+                            nb_tiles, seconds, workers.size(), 100. * efficiency, total_stolen,
+                            (seconds > 0.) ? f64(nb_rays) / seconds / 1e6 : 0.);
+    if (nb_passes > 0u)
+        util::output_to_console("Time budget: %u passes, %u samples per pixel", nb_passes, nb_samples);
+    if (cache.has_l1d || cache.has_llc)
+        util::output_to_console("Cache misses: L1D %s%.3f/ray, LLC %s%.3f/ray",
+                                cache.has_l1d ? "" : "n/a ", (nb_rays > 0u) ? f64(cache.l1d_misses) / nb_rays : 0.,
+                                cache.has_llc ? "" : "n/a ", (nb_rays > 0u) ? f64(cache.llc_misses) / nb_rays : 0.);
+}
+
+// Renderer //
+
+inline Renderer::Renderer(ThreadPool& _pool, const RenderSettings& _settings)
+    : m_pool(_pool)
+    , m_settings(_settings)
+{
+}
+
+inline RenderStats Renderer::render(const Camera& _camera, const Hitable* _world, Framebuffer* framebuffer_)
+{
+    return render(_camera, std::vector<const Hitable*> { _world }, framebuffer_);
+}
+
+inline RenderStats Renderer::render(const Camera& _camera, const std::vector<const Hitable*>& _node_worlds, Framebuffer* framebuffer_)
+{
+    sws_assert(framebuffer_);
+    sws_assert(framebuffer_->get_width() == m_settings.width && framebuffer_->get_height() == m_settings.height);
+    sws_assert(!_node_worlds.empty());
+
+    const std::vector<Tile> tiles = generate_tiles();
+    const std::vector<u32> owners = assign_tiles(u32(tiles.size()));
+    const u32 nb_tiles = u32(tiles.size());
+
+    // First touch: each tile's pages get faulted in by the worker that will trace it,
+    // placing them on that worker's node. Pinned jobs so no other node steals them.
+    if (m_pool.is_pinned())
+    {
+        for (u32 idx = 0u; idx < nb_tiles; ++idx)
+        {
+            const Tile tile = tiles[idx];
+            m_pool.submit_pinned(owners[idx], [tile, framebuffer_]()
+            {
+                framebuffer_->clear_region(tile.x0, tile.y0, tile.x1, tile.y1);
+            });
+        }
+        m_pool.wait();
+    }
+
+    // Counters are per thread: each worker opens its own before the timed part
+    std::vector<PerfCounters> counters(m_settings.use_perf_counters ? m_pool.get_nb_threads() : 0u);
+    for (u32 worker = 0u; worker < u32(counters.size()); ++worker)
+        m_pool.submit_pinned(worker, [&counters, worker]() { counters[worker].start(); });
+
+    m_pool.reset_stats();
+    m_progress.begin(u64(m_settings.width) * m_settings.height);
+
+    // Progress ratios are per pixel, meaningless across progressive passes
+    const b32 is_time_budgeted = m_settings.time_budget_seconds > 0.;
+    std::unique_ptr<ProgressReporter> reporter;
+    if (m_settings.progress_interval_ms > 0u && !is_time_budgeted)
+        reporter = std::make_unique<ProgressReporter>(m_progress, m_settings.progress_interval_ms);
+
+    RenderStats stats;
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    if (is_time_budgeted)
+    {
+        render_passes(tiles, owners, _camera, _node_worlds, framebuffer_, &stats);
+    }
+    else
+    {
+        for (u32 idx = 0u; idx < nb_tiles; ++idx)
+        {
+            const Tile tile = tiles[idx];
+            m_pool.submit_to(owners[idx], [this, tile, &_camera, &_node_worlds, framebuffer_]()
+            {
+                render_tile(tile, _camera, get_local_world(_node_worlds), framebuffer_);
+            });
+        }
+        m_pool.wait();
+        stats.nb_samples = m_settings.nb_samples;
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    reporter.reset();
+
+    stats.seconds = std::chrono::duration<f64>(end - start).count();
+    stats.nb_tiles = nb_tiles;
+    stats.nb_rays = m_progress.get_snapshot().nb_rays;
+    stats.workers = m_pool.get_stats();
+    for (const PerfCounters& worker_counters : counters)
+        stats.cache += worker_counters.read();
+    return stats;
+}
+
+inline const RenderSettings& Renderer::get_settings() const
+{
+    return m_settings;
+}
+
+inline const RenderProgress& Renderer::get_progress() const
+{
+    return m_progress;
+}
+
+inline std::vector<Tile> Renderer::generate_tiles() const
+{
+    const u32 tile_size = math::max(m_settings.tile_size, 1u);
+
+    std::vector<Tile> tiles;
+    tiles.reserve(((m_settings.width + tile_size - 1u) / tile_size) * ((m_settings.height + tile_size - 1u) / tile_size));
+
+    // Top rows first, as the original scanline loop did
+    for (u32 y1 = m_settings.height; y1 > 0u; y1 = (y1 > tile_size) ? y1 - tile_size : 0u)
+    {
+        const u32 y0 = (y1 > tile_size) ? y1 - tile_size : 0u;
+        for (u32 x0 = 0u; x0 < m_settings.width; x0 += tile_size)
+            tiles.push_back(Tile { x0, y0, math::min(x0 + tile_size, m_settings.width), y1 });
+    }
+
+    if (m_settings.tile_order != TileOrder::Scanline)
+    {
+        // Curve index of each tile on the tile grid, row 0 being the top one
+        const u32 nb_columns = (m_settings.width + tile_size - 1u) / tile_size;
+        const u32 nb_rows = u32(tiles.size()) / nb_columns;
+        const u32 side = math::next_pow2(math::max(nb_columns, nb_rows));
+
+        std::vector<std::pair<u32, Tile>> keyed(tiles.size());
+        for (usize idx = 0u; idx < tiles.size(); ++idx)
+        {
+            const u32 column = u32(idx) % nb_columns;
+            const u32 row = u32(idx) / nb_columns;
+            const u32 key = (m_settings.tile_order == TileOrder::Hilbert) ? math::hilbert_encode_2d(side, column, row)
+                                                                          : math::morton_encode_2d(column, row);
+            keyed[idx] = { key, tiles[idx] };
+        }
+        std::sort(keyed.begin(), keyed.end(), [](const auto& _a, const auto& _b) { return _a.first < _b.first; });
+        for (usize idx = 0u; idx < tiles.size(); ++idx)
+            tiles[idx] = keyed[idx].second;
+    }
+    return tiles;
+}
+
+inline std::vector<u32> Renderer::assign_tiles(u32 _nb_tiles) const
+{
+    const u32 nb_threads = m_pool.get_nb_threads();
+    const u32 nb_nodes = m_pool.get_nb_nodes();
+
+    std::vector<std::vector<u32>> node_workers(nb_nodes);
+    for (u32 worker = 0u; worker < nb_threads; ++worker)
+        node_workers[m_pool.get_worker_node(worker)].push_back(worker);
+
+    // One contiguous band of tiles (hence of framebuffer rows) per node, then contiguous
+    // runs per worker inside it: neighbouring tiles stay on the same core, stealing takes
+    // care of the imbalance between cheap and expensive regions
+    std::vector<u32> owners(_nb_tiles);
+    for (u32 node = 0u; node < nb_nodes; ++node)
+    {
+        const u32 first = u32((u64(node) * _nb_tiles) / nb_nodes);
+        const u32 last  = u32((u64(node + 1u) * _nb_tiles) / nb_nodes);
+        const std::vector<u32>& workers = node_workers[node];
+        for (u32 idx = first; idx < last; ++idx)
+            owners[idx] = workers[usize((u64(idx - first) * workers.size()) / (last - first))];
+    }
+    return owners;
+}
+
+inline void Renderer::render_passes(const std::vector<Tile>& _tiles, const std::vector<u32>& _owners, const Camera& _camera,
+                                    const std::vector<const Hitable*>& _node_worlds, Framebuffer* framebuffer_, RenderStats* stats_)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const auto start = Clock::now();
+    const u32 samples_per_pass = math::max(m_settings.samples_per_pass, 1u);
+    std::vector<fv3> accumulation(usize(m_settings.width) * m_settings.height, fv3::zero());
+
+    // At least one pass, whatever the budget: there has to be an image to return
+    f64 slowest_pass_seconds = 0.;
+    u32 nb_samples = 0u;
+    u32 nb_passes = 0u;
+    for (;;)
+    {
+        const auto pass_start = Clock::now();
+        for (usize idx = 0u; idx < _tiles.size(); ++idx)
+        {
+            const Tile tile = _tiles[idx];
+            m_pool.submit_to(_owners[idx], [this, tile, &_camera, &_node_worlds, nb_samples, samples_per_pass, &accumulation]()
+            {
+                accumulate_tile(tile, _camera, get_local_world(_node_worlds), nb_samples, samples_per_pass, accumulation.data());
+            });
+        }
+        m_pool.wait();
+
+        const auto pass_end = Clock::now();
+        nb_samples += samples_per_pass;
+        nb_passes += 1u;
+        slowest_pass_seconds = math::max(slowest_pass_seconds, std::chrono::duration<f64>(pass_end - pass_start).count());
+
+        const f64 elapsed_seconds = std::chrono::duration<f64>(pass_end - start).count();
+        if (elapsed_seconds + k_deadline_margin * slowest_pass_seconds > m_settings.time_budget_seconds ||
+            nb_samples > std::numeric_limits<u32>::max() - samples_per_pass)
+            break;
+    }
+
+    const f32 inv_nb_samples = math::inv(f32(nb_samples));
+    for (usize idx = 0u; idx < _tiles.size(); ++idx)
+    {
+        const Tile tile = _tiles[idx];
+        m_pool.submit_to(_owners[idx], [this, tile, inv_nb_samples, &accumulation, framebuffer_]()
+        {
+            for_each_pixel(tile, [&](u32 x, u32 y)
+            {
+                framebuffer_->set_pixel(x, y, to_rgb(accumulation[usize(y) * m_settings.width + x] * inv_nb_samples));
+            });
+        });
+    }
+    m_pool.wait();
+
+    stats_->nb_samples = nb_samples;
+    stats_->nb_passes = nb_passes;
+}
+
+template<typename Fn>
+inline void Renderer::for_each_pixel(const Tile& _tile, Fn&& _fn) const
+{
+    if (m_settings.pixel_order == PixelOrder::Morton)
+    {
+        // Z-order over the enclosing power-of-two square, top-left first, cells outside a partial tile are skipped
+        const u32 width = _tile.x1 - _tile.x0;
+        const u32 height = _tile.y1 - _tile.y0;
+        const u32 side = math::next_pow2(math::max(width, height));
+        for (u32 code = 0u; code < side * side; ++code)
+        {
+            u32 local_x, local_y;
+            math::morton_decode_2d(code, &local_x, &local_y);
+            if (local_x < width && local_y < height)
+                _fn(_tile.x0 + local_x, _tile.y1 - 1u - local_y);
+        }
+    }
+    else
+    {
+        for (u32 y = _tile.y1; y-- > _tile.y0;)
+        {
+            for (u32 x = _tile.x0; x < _tile.x1; ++x)
+                _fn(x, y);
+        }
+    }
+}
+
+inline fv3 Renderer::trace_sample(const Camera& _camera, const Hitable* _world, u32 _x, u32 _y, u32 _sample, f32 _sx, f32 _sy, f32 _time, u64* nb_rays_) const
+{
+    const SampleId sample { m_settings.seed, _y * m_settings.width + _x, _sample };
+    Rng camera_rng = sample.get_rng(0u);
+
+    const f32 u   = (_x + _sx) * math::inv(f32(m_settings.width));
+    const f32 v   = (_y + _sy) * math::inv(f32(m_settings.height));
+    const Ray ray = _camera.trace_ray(u, v, camera_rng);
+    return generate_color(ray, _world, _time, sample, 0, m_settings.max_depth, nb_rays_);
+}
+
+inline fv3 Renderer::trace_pixel(const Camera& _camera, const Hitable* _world, u32 _x, u32 _y, u64* nb_rays_) const
+{
+    const u32 nb_samples = m_settings.nb_samples;
+    const f32 inv_nb_samples      = math::inv(f32(nb_samples));
+    const f32 sqrt_nb_samples     = math::sqrt(f32(nb_samples));
+    const f32 inv_sqrt_nb_samples = math::inv(sqrt_nb_samples);
+
+    fv3 color = fv3::zero();
+    for (u32 s = 0u; s < nb_samples; ++s)
+    {
+        const f32 sx   = f32(std::fmod(f32(s), sqrt_nb_samples)) * inv_sqrt_nb_samples;
+        const f32 sy   = u32(s / sqrt_nb_samples) * inv_sqrt_nb_samples;
+        const f32 time = f32(s) * inv_nb_samples;
+        color += trace_sample(_camera, _world, _x, _y, s, sx, sy, time, nb_rays_);
+    }
+    color /= f32(nb_samples);
+    return color;
+}
+
+inline void Renderer::render_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, Framebuffer* framebuffer_) const
+{
+    u64 nb_rays = 0u;
+
+    for_each_pixel(_tile, [&](u32 x, u32 y)
+    {
+        framebuffer_->set_pixel(x, y, to_rgb(trace_pixel(_camera, _world, x, y, &nb_rays)));
+    });
+
+    // One batch of relaxed increments per tile, the counters stay off the per-ray path
+    const u64 nb_pixels = u64(_tile.x1 - _tile.x0) * (_tile.y1 - _tile.y0);
+    m_progress.add(nb_pixels, nb_pixels * m_settings.nb_samples, nb_rays);
+}
+
+inline u64 Renderer::trace_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, fv3* colors_) const
+{
+    u64 nb_rays = 0u;
+    const u32 width = _tile.x1 - _tile.x0;
+
+    for_each_pixel(_tile, [&](u32 x, u32 y)
+    {
+        colors_[usize(_tile.y1 - 1u - y) * width + (x - _tile.x0)] = trace_pixel(_camera, _world, x, y, &nb_rays);
+    });
+
+    const u64 nb_pixels = u64(width) * (_tile.y1 - _tile.y0);
+    m_progress.add(nb_pixels, nb_pixels * m_settings.nb_samples, nb_rays);
+    return nb_rays;
+}
+
+inline rgb Renderer::to_rgb(const fv3& _linear_color)
+{
+    return rgb((255.99f * correct_gamma(_linear_color)).cast<u8>());
+}
+
+inline void Renderer::accumulate_tile(const Tile& _tile, const Camera& _camera, const Hitable* _world, u32 _first_sample, u32 _nb_samples, fv3* accumulation_) const
+{
+    // The total sample count is unknown up front, so the stratified grid of render_tile does not
+    // apply: sub-pixel offsets and times follow R2/golden-ratio sequences, well spread for any prefix
+    constexpr f64 k_r2_x = 0.7548776662466927;
+    constexpr f64 k_r2_y = 0.5698402909980532;
+    constexpr f64 k_golden = 0.6180339887498949;
+
+    u64 nb_rays = 0u;
+
+    for_each_pixel(_tile, [&](u32 x, u32 y)
+    {
+        fv3 color = fv3::zero();
+        for (u32 s = _first_sample; s < _first_sample + _nb_samples; ++s)
+        {
+            const f32 sx   = f32(math::frac(0.5 + s * k_r2_x));
+            const f32 sy   = f32(math::frac(0.5 + s * k_r2_y));
+            const f32 time = f32(math::frac(s * k_golden));
+            color += trace_sample(_camera, _world, x, y, s, sx, sy, time, &nb_rays);
+        }
+        accumulation_[usize(y) * m_settings.width + x] += color;
+    });
+
+    const u64 nb_pixels = u64(_tile.x1 - _tile.x0) * (_tile.y1 - _tile.y0);
+    m_progress.add(nb_pixels, nb_pixels * _nb_samples, nb_rays);
+}
+
+inline const Hitable* Renderer::get_local_world(const std::vector<const Hitable*>& _node_worlds) const
+{
+    // Resolved when the tile runs: a stolen tile traces the thief's local replica
+    const u32 worker = m_pool.get_current_worker();
+    const u32 node = (worker != ThreadPool::k_invalid_worker) ? m_pool.get_worker_node(worker) : 0u;
+    return _node_worlds[math::min(node, u32(_node_worlds.size()) - 1u)];
+}
+
+constexpr fv3 Renderer::background_color(const Ray& _ray)
+{
+    const fv3 unit_dir = _ray.direction.get_normalized();
+    const f32 t = 0.5f * (unit_dir.y + 1.f);
+    return math::lerp(fv3(1.f), fv3(.5f, .7f, 1.f), t);
+}
+
+inline fv3 Renderer::generate_color(const Ray& _ray, const Hitable* _world, f32 _time, const SampleId& _sample, s32 _depth, s32 _max_depth, u64* nb_rays_)
+{
+    ++*nb_rays_;
+    if (Hit hit; _world->hit(_ray, _time, 0.001f, std::numeric_limits<f32>::max(), &hit))
+    {
+        Ray scattered;
+        fv3 attenuation;
+        Rng rng = _sample.get_rng(u32(_depth) + 1u); // bounce 0 is the camera
+        if (_depth < _max_depth && hit.material->scatter(_ray, hit, rng, &attenuation, &scattered))
+            return attenuation * generate_color(scattered, _world, _time, _sample, _depth + 1, _max_depth, nb_rays_);
+
+        return fv3::zero();
+    }
+    return background_color(_ray);
+}
+
+inline fv3 Renderer::correct_gamma(const fv3& _color)
+{
+    // Formula: Vout = A * pow( Vin, y ) with A = 1 and y = 1/2
+    return fv3(math::sqrt(_color.x), math::sqrt(_color.y), math::sqrt(_color.z));
+}
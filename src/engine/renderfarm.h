@@ -0,0 +1,482 @@
+// ======================================================================
+// File: renderfarm.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+
+#include "engine/camera.h"
+#include "engine/framebuffer.h"
+#include "engine/hitable.h"
+#include "engine/renderer.h"
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Workers re-run the executable through /proc/self/exe, which only Linux provides
+#if defined(__linux__)
+#define SWS_RENDER_FARM 1
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+// One frame spread over several local processes. The coordinator spawns workers
+// (the same executable, re-run with --farm-worker), each loads the scene and builds
+// its own BVH, then pulls tiles over a Unix socket and streams back linear float
+// colors. The coordinator gamma-corrects and quantizes them exactly as the in-process
+// renderer does, so the assembled image is byte-identical to a local render.
+//
+// Slow workers: once no tile is left to hand out, an idle worker gets a duplicate of
+// the oldest in-flight tile that runs longer than speculation_factor x the mean tile
+// time; whichever copy arrives first is kept. Dead workers: their in-flight tiles go
+// back to the front of the queue.
+namespace farm
+{
+    struct Settings
+    {
+        u32 nb_workers = 0u;               // 0: one per hardware thread
+        u32 max_in_flight = 2u;            // tiles queued per worker, hides the round trip
+        f64 speculation_factor = 2.;
+        std::string socket_path;           // empty: /tmp/sws_farm_<pid>.sock
+        std::vector<std::string> worker_args; // command line of the worker processes, without argv[0]
+    };
+
+    struct Stats
+    {
+        inline void print() const;
+
+        f64 seconds = 0.;
+        u32 nb_tiles = 0u;
+        u32 nb_workers = 0u;
+        u32 nb_assigned = 0u;
+        u32 nb_speculative = 0u;  // duplicates handed to idle workers
+        u32 nb_duplicates = 0u;   // results dropped because another copy was first
+        u32 nb_requeued = 0u;     // tiles taken back from dead workers
+        u32 nb_workers_lost = 0u;
+        u64 nb_rays = 0u;
+    };
+
+    // Debug knobs of a worker process, used to exercise the recovery paths
+    struct WorkerFaults
+    {
+        u32 slow_ms = 0u;       // sleep after every tile
+        u32 exit_after = 0u;    // abort without answering after this many tiles, 0 never
+    };
+
+    // Returns false if the frame could not be completed (every worker lost)
+    inline b32 run_coordinator(const Settings& _settings, const std::vector<Tile>& _tiles, Framebuffer* framebuffer_, Stats* stats_);
+    inline s32 run_worker(const std::string& _socket_path, u32 _worker_idx, const Renderer& _renderer, const Camera& _camera,
+                          const Hitable* _world, const WorkerFaults& _faults);
+
+    inline b32 is_supported();
+
+    // Stats //
+
+    inline void Stats::print() const
+    {
+        util::output_to_console("Farm: %u tiles in %.3fs on %u workers (%.2f Mrays/s), %u assignments, %u speculative, "
+                                "%u duplicates dropped, %u requeued, %u workers lost",
+                                nb_tiles, seconds, nb_workers, (seconds > 0.) ? f64(nb_rays) / seconds / 1e6 : 0.,
+                                nb_assigned, nb_speculative, nb_duplicates, nb_requeued, nb_workers_lost);
+    }
+
+#if defined(SWS_RENDER_FARM)
+
+    namespace internal
+    {
+        enum class MessageType : u32 { Hello, Assign, Result, Done };
+
+        struct MessageHeader
+        {
+            MessageType type;
+            u32 tile_idx;
+            u32 size; // payload bytes following the header
+            u32 pad;
+        };
+
+        struct ResultHeader
+        {
+            Tile tile;
+            u64 nb_rays;
+        };
+
+        inline b32 send_all(s32 _fd, const void* _data, usize _size)
+        {
+            const u8* bytes = static_cast<const u8*>(_data);
+            while (_size > 0u)
+            {
+#if defined(MSG_NOSIGNAL)
+                const ssize_t nb_sent = ::send(_fd, bytes, _size, MSG_NOSIGNAL);
+#else
+                const ssize_t nb_sent = ::send(_fd, bytes, _size, 0);
+#endif
+                if (nb_sent < 0 && errno == EINTR)
+                    continue;
+                if (nb_sent <= 0)
+                    return false;
+                bytes += nb_sent;
+                _size -= usize(nb_sent);
+            }
+            return true;
+        }
+
+        inline b32 recv_all(s32 _fd, void* data_, usize _size)
+        {
+            u8* bytes = static_cast<u8*>(data_);
+            while (_size > 0u)
+            {
+                const ssize_t nb_read = ::recv(_fd, bytes, _size, 0);
+                if (nb_read < 0 && errno == EINTR)
+                    continue;
+                if (nb_read <= 0)
+                    return false;
+                bytes += nb_read;
+                _size -= usize(nb_read);
+            }
+            return true;
+        }
+
+        inline b32 send_message(s32 _fd, MessageType _type, u32 _tile_idx, const void* _payload = nullptr, u32 _size = 0u)
+        {
+            const MessageHeader header { _type, _tile_idx, _size, 0u };
+            return send_all(_fd, &header, sizeof(header)) && (_size == 0u || send_all(_fd, _payload, _size));
+        }
+
+        inline b32 recv_message(s32 _fd, MessageHeader* header_, std::vector<u8>* payload_)
+        {
+            if (!recv_all(_fd, header_, sizeof(*header_)))
+                return false;
+            payload_->resize(header_->size);
+            return header_->size == 0u || recv_all(_fd, payload_->data(), header_->size);
+        }
+
+        inline sockaddr_un get_address(const std::string& _socket_path)
+        {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", _socket_path.c_str());
+            return address;
+        }
+
+        struct Peer
+        {
+            s32 fd = -1;
+            u32 worker_idx = ~0u;
+            std::vector<u32> in_flight;
+        };
+
+        struct Assignment
+        {
+            u32 nb_copies = 0u;
+            std::chrono::steady_clock::time_point start;
+        };
+    }
+
+    inline b32 is_supported()
+    {
+        return true;
+    }
+
+    inline b32 run_coordinator(const Settings& _settings, const std::vector<Tile>& _tiles, Framebuffer* framebuffer_, Stats* stats_)
+    {
+        using namespace internal;
+        using Clock = std::chrono::steady_clock;
+
+        const auto start = Clock::now();
+        const u32 nb_tiles = u32(_tiles.size());
+        const u32 nb_workers = (_settings.nb_workers > 0u) ? _settings.nb_workers : math::max(std::thread::hardware_concurrency(), 1u);
+        const std::string socket_path = !_settings.socket_path.empty() ? _settings.socket_path
+                                                                       : "/tmp/sws_farm_" + std::to_string(getpid()) + ".sock";
+        *stats_ = {};
+        stats_->nb_tiles = nb_tiles;
+        stats_->nb_workers = nb_workers;
+
+        const s32 listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un address = get_address(socket_path);
+        ::unlink(socket_path.c_str());
+        if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd, s32(nb_workers)) != 0)
+        {
+            util::output_to_console("Farm: cannot listen on %s (errno %d)", socket_path.c_str(), errno);
+            if (listen_fd >= 0)
+                ::close(listen_fd);
+            return false;
+        }
+
+        // Workers are this same executable, switched to worker mode by the extra arguments. The
+        // argument vector is built before fork(): the pool threads may hold the malloc lock, so
+        // the child only calls async-signal-safe functions until execv()
+        std::vector<pid_t> pids;
+        for (u32 worker_idx = 0u; worker_idx < nb_workers; ++worker_idx)
+        {
+            std::vector<std::string> args = { "/proc/self/exe" };
+            args.insert(args.end(), _settings.worker_args.begin(), _settings.worker_args.end());
+            args.insert(args.end(), { "--farm-worker", socket_path, "--farm-worker-index", std::to_string(worker_idx) });
+            std::vector<utf8*> argv;
+            for (std::string& arg : args)
+                argv.push_back(arg.data());
+            argv.push_back(nullptr);
+
+            const pid_t pid = ::fork();
+            if (pid == 0)
+            {
+                ::close(listen_fd);
+                ::execv(argv[0], argv.data());
+                ::_exit(127);
+            }
+            if (pid > 0)
+                pids.push_back(pid);
+        }
+
+        std::vector<Peer> peers;
+        std::deque<u32> pending;
+        for (u32 idx = 0u; idx < nb_tiles; ++idx)
+            pending.push_back(idx);
+        std::vector<Assignment> assignments(nb_tiles);
+        std::vector<b32> is_done(nb_tiles, false);
+        u32 nb_done = 0u;
+        u32 nb_exited = 0u;
+        f64 total_tile_seconds = 0.;
+        u32 nb_timed_tiles = 0u;
+        std::vector<u8> payload;
+
+        auto assign = [&](Peer& _peer, u32 _tile_idx) -> b32
+        {
+            if (!send_message(_peer.fd, MessageType::Assign, _tile_idx, &_tiles[_tile_idx], sizeof(Tile)))
+                return false;
+            _peer.in_flight.push_back(_tile_idx);
+            if (assignments[_tile_idx].nb_copies++ == 0u)
+                assignments[_tile_idx].start = Clock::now();
+            stats_->nb_assigned += 1u;
+            return true;
+        };
+
+        auto drop_peer = [&](usize _peer_idx)
+        {
+            Peer& peer = peers[_peer_idx];
+            for (const u32 tile_idx : peer.in_flight)
+            {
+                assignments[tile_idx].nb_copies -= 1u;
+                if (!is_done[tile_idx] && assignments[tile_idx].nb_copies == 0u)
+                {
+                    pending.push_front(tile_idx);
+                    stats_->nb_requeued += 1u;
+                }
+            }
+            ::close(peer.fd);
+            peers.erase(peers.begin() + sptr(_peer_idx));
+            stats_->nb_workers_lost += 1u;
+        };
+
+        while (nb_done < nb_tiles)
+        {
+            // Reap exited children; once all are gone and no connection is left, nobody can finish the frame
+            for (s32 status = 0; ::waitpid(-1, &status, WNOHANG) > 0;)
+                nb_exited += 1u;
+            if (peers.empty() && nb_exited >= u32(pids.size()))
+                break;
+
+            std::vector<pollfd> fds;
+            fds.push_back(pollfd { listen_fd, POLLIN, 0 });
+            for (const Peer& peer : peers)
+                fds.push_back(pollfd { peer.fd, POLLIN, 0 });
+            if (::poll(fds.data(), nfds_t(fds.size()), 20) < 0 && errno != EINTR)
+                break;
+
+            if (fds[0].revents & POLLIN)
+            {
+                const s32 fd = ::accept(listen_fd, nullptr, nullptr);
+                MessageHeader header;
+                if (fd >= 0 && recv_message(fd, &header, &payload) && header.type == MessageType::Hello)
+                    peers.push_back(Peer { fd, header.tile_idx, {} });
+                else if (fd >= 0)
+                    ::close(fd);
+            }
+
+            // Results, or hang-ups, walking backwards so dropping a peer keeps the indices valid
+            for (usize idx = fds.size() - 1u; idx > 0u; --idx)
+            {
+                if (!(fds[idx].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+
+                const usize peer_idx = idx - 1u;
+                Peer& peer = peers[peer_idx];
+                MessageHeader header;
+                if (!recv_message(peer.fd, &header, &payload) || header.type != MessageType::Result)
+                {
+                    drop_peer(peer_idx);
+                    continue;
+                }
+
+                // A result for a tile this peer was not given, or of the wrong size, means a broken worker
+                const u32 tile_idx = header.tile_idx;
+                const auto in_flight = std::find(peer.in_flight.begin(), peer.in_flight.end(), tile_idx);
+                if (tile_idx >= nb_tiles || in_flight == peer.in_flight.end() ||
+                    payload.size() != sizeof(ResultHeader) + usize(_tiles[tile_idx].x1 - _tiles[tile_idx].x0) * (_tiles[tile_idx].y1 - _tiles[tile_idx].y0) * sizeof(fv3))
+                {
+                    drop_peer(peer_idx);
+                    continue;
+                }
+
+                ResultHeader result;
+                std::memcpy(&result, payload.data(), sizeof(result));
+                peer.in_flight.erase(in_flight);
+                assignments[tile_idx].nb_copies -= 1u;
+                if (is_done[tile_idx])
+                {
+                    stats_->nb_duplicates += 1u;
+                    continue;
+                }
+
+                const Tile& tile = _tiles[tile_idx];
+                const u32 width = tile.x1 - tile.x0;
+                const fv3* colors = reinterpret_cast<const fv3*>(payload.data() + sizeof(ResultHeader));
+                for (u32 y = tile.y0; y < tile.y1; ++y)
+                {
+                    for (u32 x = tile.x0; x < tile.x1; ++x)
+                        framebuffer_->set_pixel(x, y, Renderer::to_rgb(colors[usize(tile.y1 - 1u - y) * width + (x - tile.x0)]));
+                }
+
+                is_done[tile_idx] = true;
+                nb_done += 1u;
+                stats_->nb_rays += result.nb_rays;
+                total_tile_seconds += std::chrono::duration<f64>(Clock::now() - assignments[tile_idx].start).count();
+                nb_timed_tiles += 1u;
+            }
+
+            // Hand out work: queued tiles first, then duplicates of the stragglers
+            for (usize peer_idx = 0u; peer_idx < peers.size(); ++peer_idx)
+            {
+                Peer& peer = peers[peer_idx];
+                b32 is_alive = true;
+                while (is_alive && peer.in_flight.size() < _settings.max_in_flight && !pending.empty())
+                {
+                    const u32 tile_idx = pending.front();
+                    pending.pop_front();
+                    if (!is_done[tile_idx] && !(is_alive = assign(peer, tile_idx)))
+                        pending.push_front(tile_idx);
+                }
+
+                if (is_alive && peer.in_flight.empty() && pending.empty() && nb_timed_tiles > 0u)
+                {
+                    const f64 threshold = _settings.speculation_factor * total_tile_seconds / nb_timed_tiles;
+                    u32 straggler = ~0u;
+                    f64 straggler_seconds = threshold;
+                    for (u32 tile_idx = 0u; tile_idx < nb_tiles; ++tile_idx)
+                    {
+                        if (is_done[tile_idx] || assignments[tile_idx].nb_copies != 1u)
+                            continue;
+                        const f64 seconds = std::chrono::duration<f64>(Clock::now() - assignments[tile_idx].start).count();
+                        if (seconds > straggler_seconds)
+                        {
+                            straggler = tile_idx;
+                            straggler_seconds = seconds;
+                        }
+                    }
+                    if (straggler != ~0u)
+                    {
+                        is_alive = assign(peer, straggler);
+                        stats_->nb_speculative += is_alive ? 1u : 0u;
+                    }
+                }
+
+                if (!is_alive)
+                    drop_peer(peer_idx--);
+            }
+        }
+
+        for (const Peer& peer : peers)
+        {
+            send_message(peer.fd, MessageType::Done, 0u);
+            ::close(peer.fd);
+        }
+        for (const pid_t pid : pids)
+        {
+            // Workers busy on a dropped duplicate would only finish a useless tile
+            ::kill(pid, SIGTERM);
+            ::waitpid(pid, nullptr, 0);
+        }
+        ::close(listen_fd);
+        ::unlink(socket_path.c_str());
+
+        stats_->seconds = std::chrono::duration<f64>(Clock::now() - start).count();
+        if (nb_done < nb_tiles)
+            util::output_to_console("Farm: every worker was lost, %u of %u tiles rendered", nb_done, nb_tiles);
+        return nb_done == nb_tiles;
+    }
+
+    inline s32 run_worker(const std::string& _socket_path, u32 _worker_idx, const Renderer& _renderer, const Camera& _camera,
+                          const Hitable* _world, const WorkerFaults& _faults)
+    {
+        using namespace internal;
+
+        const s32 fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const sockaddr_un address = get_address(_socket_path);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            !send_message(fd, MessageType::Hello, _worker_idx))
+        {
+            util::output_to_console("Farm worker %u: cannot reach the coordinator at %s", _worker_idx, _socket_path.c_str());
+            return 1;
+        }
+
+        u32 nb_rendered = 0u;
+        std::vector<u8> payload;
+        std::vector<u8> result;
+        for (MessageHeader header; recv_message(fd, &header, &payload) && header.type == MessageType::Assign;)
+        {
+            if (_faults.exit_after > 0u && nb_rendered >= _faults.exit_after)
+                ::_exit(3);
+
+            ResultHeader result_header;
+            std::memcpy(&result_header.tile, payload.data(), sizeof(Tile));
+            const Tile& tile = result_header.tile;
+            const usize nb_pixels = usize(tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+
+            result.resize(sizeof(ResultHeader) + nb_pixels * sizeof(fv3));
+            result_header.nb_rays = _renderer.trace_tile(tile, _camera, _world, reinterpret_cast<fv3*>(result.data() + sizeof(ResultHeader)));
+            std::memcpy(result.data(), &result_header, sizeof(result_header));
+            nb_rendered += 1u;
+
+            if (_faults.slow_ms > 0u)
+                std::this_thread::sleep_for(std::chrono::milliseconds(_faults.slow_ms));
+
+            if (!send_message(fd, MessageType::Result, header.tile_idx, result.data(), u32(result.size())))
+                break;
+        }
+
+        ::close(fd);
+        return 0;
+    }
+
+#else
+
+    inline b32 is_supported()
+    {
+        return false;
+    }
+
+    inline b32 run_coordinator(const Settings&, const std::vector<Tile>&, Framebuffer*, Stats*)
+    {
+        util::output_to_console("Farm: the local render farm requires Linux (Unix sockets and /proc/self/exe)");
+        return false;
+    }
+
+    inline s32 run_worker(const std::string&, u32, const Renderer&, const Camera&, const Hitable*, const WorkerFaults&)
+    {
+        return 1;
+    }
+
+#endif
+}
@@ -0,0 +1,149 @@
+// ======================================================================
+// File: scenebuilder.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/rng.h"
+#include "core/threadpool.h"
+#include "core/utils.h"
+
+#include "engine/hitable.h"
+#include "engine/hitablelist.h"
+
+#include <functional>
+#include <vector>
+
+// Parallel procedural scene construction. A generator is called once per index with
+// an Rng keyed by (seed, batch, index) and emits any number of primitives into
+// the chunk being filled. Chunks cover fixed index ranges and are concatenated in
+// index order, so the resulting list does not depend on the thread count or on the
+// order the chunks ran in.
+class SceneBuilder
+{
+    NON_COPYABLE(SceneBuilder);
+
+public:
+    class Chunk
+    {
+    public:
+        inline void add(Hitable* _hitable);
+
+    private:
+        friend class SceneBuilder;
+        std::vector<Hitable*> m_hitables;
+    };
+
+    using Generator = std::function<void(u32 _index, Rng& _rng, Chunk* chunk_)>;
+
+public:
+    // Without a pool, or when called from a pool worker, generation runs on the calling thread
+    inline SceneBuilder(ThreadPool* _pool, u64 _seed, u32 _chunk_size = 1024u);
+    inline ~SceneBuilder();
+
+    inline void add(Hitable* _hitable);
+    inline void generate(u32 _count, const Generator& _generator);
+
+    // Moves every primitive, in emission order, into a new list
+    inline HitableList* build();
+
+    inline u32 get_size() const;
+
+private:
+    ThreadPool* m_pool;
+    u64 m_seed;
+    u32 m_chunk_size;
+    u32 m_nb_batches = 0u;
+    std::vector<Chunk> m_chunks; // emission order
+    b32 m_is_last_chunk_serial = false; // consecutive add() calls share a chunk
+};
+
+// SceneBuilder::Chunk //
+
+inline void SceneBuilder::Chunk::add(Hitable* _hitable)
+{
+    m_hitables.push_back(_hitable);
+}
+
+// SceneBuilder //
+
+inline SceneBuilder::SceneBuilder(ThreadPool* _pool, u64 _seed, u32 _chunk_size)
+    : m_pool(_pool)
+    , m_seed(_seed)
+    , m_chunk_size(math::max(_chunk_size, 1u))
+{
+}
+
+inline SceneBuilder::~SceneBuilder()
+{
+    for (Chunk& chunk : m_chunks)
+    {
+        for (Hitable*& hitable : chunk.m_hitables)
+            util::safe_del(hitable);
+    }
+}
+
+inline void SceneBuilder::add(Hitable* _hitable)
+{
+    if (!m_is_last_chunk_serial)
+        m_chunks.emplace_back();
+    m_is_last_chunk_serial = true;
+    m_chunks.back().add(_hitable);
+}
+
+inline void SceneBuilder::generate(u32 _count, const Generator& _generator)
+{
+    const u32 batch = m_nb_batches++;
+    m_is_last_chunk_serial = false;
+    const usize first_chunk = m_chunks.size();
+    const u32 nb_chunks = (_count + m_chunk_size - 1u) / m_chunk_size;
+    m_chunks.resize(first_chunk + nb_chunks);
+
+    auto fill_chunk = [this, batch, _count, &_generator](u32 _chunk_idx, Chunk* chunk_)
+    {
+        const u32 begin = _chunk_idx * m_chunk_size;
+        const u32 end = math::min(begin + m_chunk_size, _count);
+        chunk_->m_hitables.reserve(end - begin);
+        for (u32 idx = begin; idx < end; ++idx)
+        {
+            Rng rng = Rng::from_sample(m_seed, idx, batch);
+            _generator(idx, rng, chunk_);
+        }
+    };
+
+    const b32 is_parallel = m_pool && m_pool->get_nb_threads() > 1u && m_pool->get_current_worker() == ThreadPool::k_invalid_worker;
+    for (u32 chunk_idx = 0u; chunk_idx < nb_chunks; ++chunk_idx)
+    {
+        Chunk* chunk = &m_chunks[first_chunk + chunk_idx];
+        if (is_parallel)
+            m_pool->submit([&fill_chunk, chunk_idx, chunk]() { fill_chunk(chunk_idx, chunk); });
+        else
+            fill_chunk(chunk_idx, chunk);
+    }
+    if (is_parallel)
+        m_pool->wait();
+}
+
+inline HitableList* SceneBuilder::build()
+{
+    HitableList* list = new HitableList(math::max(get_size(), 1u));
+    for (Chunk& chunk : m_chunks)
+    {
+        for (Hitable* hitable : chunk.m_hitables)
+            list->add(hitable);
+    }
+    m_chunks.clear();
+    m_is_last_chunk_serial = false;
+    return list;
+}
+
+inline u32 SceneBuilder::get_size() const
+{
+    usize size = 0u;
+    for (const Chunk& chunk : m_chunks)
+        size += chunk.m_hitables.size();
+    return u32(size);
+}
@@ -0,0 +1,297 @@
+// ======================================================================
+// File: scenes.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/threadpool.h"
+#include "core/utils.h"
+
+#include "engine/bvh.h"
+#include "engine/bvhfactory.h"
+#include "engine/hitablelist.h"
+#include "engine/instance.h"
+#include "engine/material.h"
+#include "engine/plane.h"
+#include "engine/scenebuilder.h"
+#include "engine/sphere.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// A scene split in the stages the frame pipeline runs as separate tasks. Image decoding
+// and the BVH build only depend on the primitives, not on each other.
+struct SceneBuild
+{
+    HitableList* primitives = nullptr;
+    std::vector<ImageTexture*> textures; // created undecoded, owned by their materials
+    b32 use_bvh = false;
+    Hitable* world = nullptr;
+};
+
+// One of the random scene's small spheres: diffuse and bouncing, metal or glass
+inline Sphere* create_small_sphere(const fv3& _center, f32 _mat_to_choose, Rng& _rng)
+{
+    // Draws are kept in separate statements: argument evaluation order is unspecified
+    // and the scene has to be the same for a given seed whatever the compiler does
+    auto rnd_fv3 = [](auto&& _fn) { const f32 x = _fn(); const f32 y = _fn(); const f32 z = _fn(); return fv3(x, y, z); };
+
+    if (_mat_to_choose < 0.8f) // Diffuse
+    {
+        auto rnd_sqr_unit = [&_rng]() { return util::frand_01(_rng) * util::frand_01(_rng); };
+        Transform tf(_center, _center + fv3(0.f, 0.5f * util::frand_01(_rng), 0.f));
+        Material* mt = new Lambertian(new ConstTexture(rnd_fv3(rnd_sqr_unit)));
+        return new Sphere(std::move(tf), 0.2f, mt);
+    }
+    else if (_mat_to_choose < 0.95f) // Metal
+    {
+        auto rnd_half_unit = [&_rng]() { return 0.5f * (1.f + util::frand_01(_rng)); };
+        Transform tf(_center);
+        const fv3 albedo = rnd_fv3(rnd_half_unit);
+        Material* mt = new Metal(albedo, 0.5f * util::frand_01(_rng));
+        return new Sphere(std::move(tf), 0.2f, mt);
+    }
+    else // Glass
+    {
+        Transform tf(_center);
+        return new Sphere(std::move(tf), 0.2f, new Dielectric(1.5f));
+    }
+}
+
+inline void add_ground_sphere(SceneBuilder* builder_)
+{
+    Texture* checker = new CheckerTexture(new ConstTexture(fv3(0.2f, 0.3f, 0.1f)), new ConstTexture(fv3(0.9f, 0.9f, 0.9f)));
+    builder_->add(new Sphere(Transform(fv3(0.f, -1000.f, 0.f)), 1000.f, new Lambertian(checker)));
+}
+
+// The same ground as an infinite plane, just below y = 0 like the sphere's top: the checker's
+// sin(10 y) factor would flip sign with every rounding of the hit point at y = 0
+inline void add_ground_plane(SceneBuilder* builder_)
+{
+    Texture* checker = new CheckerTexture(new ConstTexture(fv3(0.2f, 0.3f, 0.1f)), new ConstTexture(fv3(0.9f, 0.9f, 0.9f)));
+    builder_->add(new Plane(Transform(fv3(0.f, -0.01f, 0.f)), fv3(0.f, 1.f, 0.f), new Lambertian(checker)));
+}
+
+inline void add_big_spheres(SceneBuilder* builder_)
+{
+    builder_->add(new Sphere(Transform(fv3(0.f, 1.f, 0.f)),  1.f, new Dielectric(1.5f)));
+    builder_->add(new Sphere(Transform(fv3(-4.f, 1.f, 0.f)), 1.f, new Lambertian(new ConstTexture(fv3(0.4f, 0.2f, 0.1f)))));
+    builder_->add(new Sphere(Transform(fv3(4.f, 1.f, 0.f)),  1.f, new Metal(fv3(0.7f, 0.2f, 0.5f), 0.f)));
+}
+
+// Small spheres on a (2 * _grid_extent)^2 grid around the three big ones. Every grid cell
+// draws from its own generator, cells are built in parallel when a pool is given. The ground
+// is the 1000-radius sphere or, with _has_ground_plane, an infinite plane.
+inline HitableList* generate_rand_world(ThreadPool* _pool, u64 _seed, u32 _grid_extent = 10u, b32 _has_ground_plane = false)
+{
+    SceneBuilder builder(_pool, _seed);
+    if (_has_ground_plane)
+        add_ground_plane(&builder);
+    else
+        add_ground_sphere(&builder);
+
+    const u32 grid_size = 2u * _grid_extent;
+    builder.generate(grid_size * grid_size, [grid_size, _grid_extent](u32 _index, Rng& _rng, SceneBuilder::Chunk* chunk_)
+    {
+        const s32 a = s32(_index / grid_size) - s32(_grid_extent);
+        const s32 b = s32(_index % grid_size) - s32(_grid_extent);
+
+        const f32 mat_to_choose = util::frand_01(_rng);
+        const f32 offset_x = 0.9f * util::frand_01(_rng);
+        const f32 offset_z = 0.9f * util::frand_01(_rng);
+        const fv3 center(a + offset_x, 0.2f, b + offset_z);
+
+        if ((center - fv3(4.f, 0.2f, 0.f)).get_length() > 0.9f)
+            chunk_->add(create_small_sphere(center, mat_to_choose, _rng));
+    });
+
+    add_big_spheres(&builder);
+    return builder.build();
+}
+
+// The random scene's layout at a coarser scale: a few tiles of small spheres are built once,
+// each with its own BVH, and placed on a (2 * _grid_extent)^2 grid with a random tile, turn
+// and size per cell. Only the tiles' spheres exist in memory, a cell is one Instance.
+inline HitableList* generate_instanced_world(ThreadPool* _pool, u64 _seed, u32 _grid_extent = 10u)
+{
+    constexpr u32 k_nb_tiles = 4u;
+    constexpr u32 k_tile_extent = 2u; // (2 * extent)^2 spheres on unit cells around the origin
+    constexpr f32 k_cell_size = 2.f * f32(k_tile_extent);
+
+    std::shared_ptr<const Hitable> tiles[k_nb_tiles];
+    for (u32 tile = 0u; tile < k_nb_tiles; ++tile)
+    {
+        // Streams apart from the placement one, which uses the scene seed
+        SceneBuilder tile_builder(nullptr, _seed ^ (0x9e3779b97f4a7c15ull * (tile + 1u)));
+        const u32 tile_size = 2u * k_tile_extent;
+        tile_builder.generate(tile_size * tile_size, [tile_size](u32 _index, Rng& _rng, SceneBuilder::Chunk* chunk_)
+        {
+            const s32 a = s32(_index / tile_size) - s32(k_tile_extent);
+            const s32 b = s32(_index % tile_size) - s32(k_tile_extent);
+
+            const f32 mat_to_choose = util::frand_01(_rng);
+            const f32 offset_x = 0.1f + 0.8f * util::frand_01(_rng);
+            const f32 offset_z = 0.1f + 0.8f * util::frand_01(_rng);
+            chunk_->add(create_small_sphere(fv3(a + offset_x, 0.2f, b + offset_z), mat_to_choose, _rng));
+        });
+        tiles[tile] = std::make_shared<InstanceGeometry>(tile_builder.build());
+    }
+
+    SceneBuilder builder(_pool, _seed);
+    add_ground_sphere(&builder);
+
+    const u32 grid_size = 2u * _grid_extent;
+    builder.generate(grid_size * grid_size, [&tiles, grid_size, _grid_extent](u32 _index, Rng& _rng, SceneBuilder::Chunk* chunk_)
+    {
+        const s32 a = s32(_index / grid_size) - s32(_grid_extent);
+        const s32 b = s32(_index % grid_size) - s32(_grid_extent);
+        const fv3 center(k_cell_size * (f32(a) + 0.5f), 0.f, k_cell_size * (f32(b) + 0.5f));
+
+        const u32 tile = _rng.next_bounded(k_nb_tiles);
+        const f32 angle = math::Pi2<f32> * util::frand_01(_rng);
+        const f32 scale = 0.6f + 0.4f * util::frand_01(_rng);
+
+        // The cells around the big spheres stay empty
+        if (math::abs(center.x) > 6.f || math::abs(center.z) > 2.f)
+        {
+            const Affine object_to_world = Affine::from_translation(center) * Affine::from_rotation(fv3(0.f, 1.f, 0.f), angle) *
+                                           Affine::from_scale(fv3(scale));
+            chunk_->add(new Instance(tiles[tile], object_to_world));
+        }
+    });
+
+    add_big_spheres(&builder);
+    return builder.build();
+}
+
+inline HitableList* generate_perlin_spheres(std::vector<ImageTexture*>* textures_)
+{
+    Texture* t1 = new NoiseTexture(1);
+    ImageTexture* t2 = new ImageTexture(util::get_data_path() / "earth_daymap.jpg", ImageTexture::Deferred {});
+    textures_->push_back(t2);
+    HitableList* list = new HitableList(2);
+    list->add(new Sphere(Transform(fv3(0.f, -1000.f, 0.f)), 1000.f, new Lambertian(t1)));
+    list->add(new Sphere(Transform(fv3(0.f, 2.f, 0.f)), 2.f, new Lambertian(t2)));
+    return list;
+}
+
+inline SceneBuild build_scene_primitives(const std::string& _name, u64 _seed, ThreadPool* _pool = nullptr, u32 _grid_extent = 10u)
+{
+    SceneBuild scene;
+    if (_name == "random" || _name == "random-plane")
+    {
+        scene.primitives = generate_rand_world(_pool, _seed, _grid_extent, _name == "random-plane");
+        scene.use_bvh = true;
+    }
+    else if (_name == "instanced")
+    {
+        scene.primitives = generate_instanced_world(_pool, _seed, _grid_extent);
+        scene.use_bvh = true;
+    }
+    else
+    {
+        scene.primitives = generate_perlin_spheres(&scene.textures);
+    }
+    return scene;
+}
+
+// A dynamic BVH is refitted or rebuilt with DynamicBVH::update() when the primitives move,
+// behind an OutlierBVH when create_bvh() would have kept some primitives out of the tree
+inline void build_scene_bvh(SceneBuild* scene_, const BVHSettings& _bvh_settings = {}, b32 _is_dynamic = false)
+{
+    if (!scene_->use_bvh)
+        scene_->world = scene_->primitives;
+    else if (_is_dynamic)
+        scene_->world = OutlierBVH::create(scene_->primitives->get_buffer(), scene_->primitives->get_size(), 0.f, 1.f, _bvh_settings.outlier_area_ratio,
+                                           [&](Hitable** _hitables, u32 _nb_hitables) -> Hitable* { return new DynamicBVH(_hitables, _nb_hitables, 0.f, 1.f, _bvh_settings); });
+    else
+        scene_->world = create_bvh(scene_->primitives->get_buffer(), scene_->primitives->get_size(), 0.0, 1.0, _bvh_settings);
+}
+
+// Swirls a scene around the y axis: every entity turns at a rate that falls off with its
+// distance from the axis, so neighbours drift apart and a BVH built on the first frame keeps
+// losing quality. The ground sphere sits on the axis and stays; motion blur paths are kept.
+class SceneAnimation
+{
+public:
+    inline explicit SceneAnimation(HitableList* _primitives);
+
+    // In turns of the entities closest to the axis
+    inline void set_time(f32 _time);
+
+private:
+    static constexpr f32 k_falloff_distance = 4.f; // entities this far out turn at half the rate
+
+    struct Keyframe
+    {
+        Entity* entity;
+        fv3 position; // at time 0
+    };
+    std::vector<Keyframe> m_keyframes;
+};
+
+inline SceneAnimation::SceneAnimation(HitableList* _primitives)
+{
+    for (u32 idx = 0u; idx < _primitives->get_size(); ++idx)
+    {
+        if (Entity* entity = dynamic_cast<Entity*>(_primitives->get_buffer()[idx]))
+            m_keyframes.push_back({ entity, entity->transform.get_position(0.f) });
+    }
+}
+
+inline void SceneAnimation::set_time(f32 _time)
+{
+    for (const Keyframe& keyframe : m_keyframes)
+    {
+        const fv3& p = keyframe.position;
+        const f32 distance = math::sqrt(p.x * p.x + p.z * p.z);
+        const f32 angle = math::Pi2<f32> * _time * k_falloff_distance / (k_falloff_distance + distance);
+        keyframe.entity->transform.set_position(fv3(p.x * math::cos(angle) - p.z * math::sin(angle), p.y,
+                                                    p.x * math::sin(angle) + p.z * math::cos(angle)));
+    }
+}
+
+// All stages in sequence on the calling thread
+inline Hitable* generate_scene(const std::string& _name, u64 _seed, ThreadPool* _pool = nullptr, u32 _grid_extent = 10u,
+                               const BVHSettings& _bvh_settings = {})
+{
+    SceneBuild scene = build_scene_primitives(_name, _seed, _pool, _grid_extent);
+    for (ImageTexture* texture : scene.textures)
+        texture->decode();
+    build_scene_bvh(&scene, _bvh_settings);
+    return scene.world;
+}
+
+// Builds one copy of the scene per NUMA node of the pool, each on a worker of that
+// node so its allocations (spheres, materials, BVH nodes) are first-touched locally.
+// The same seed gives identical replicas.
+inline std::vector<Hitable*> generate_scene_replicas(ThreadPool& _pool, const std::string& _name, u64 _seed, u32 _grid_extent = 10u,
+                                                     const BVHSettings& _bvh_settings = {})
+{
+    // Each replica builds its BVH serially on its own node, a shared build pool would spread
+    // the first touches across the machine. So would a cached tree: its pages are mapped once
+    BVHSettings bvh_settings = _bvh_settings;
+    bvh_settings.pool = nullptr;
+    bvh_settings.build_stats = nullptr; // the replicas build concurrently
+    bvh_settings.cache_dir.clear();
+
+    std::vector<Hitable*> replicas(_pool.get_nb_nodes(), nullptr);
+    for (u32 worker = 0u; worker < _pool.get_nb_threads(); ++worker)
+    {
+        const u32 node = _pool.get_worker_node(worker);
+        if (worker > 0u && _pool.get_worker_node(worker - 1u) == node)
+            continue;
+
+        Hitable** replica = &replicas[node];
+        _pool.submit_pinned(worker, [replica, &_name, _seed, _grid_extent, &bvh_settings]()
+        {
+            *replica = generate_scene(_name, _seed, nullptr, _grid_extent, bvh_settings);
+        });
+    }
+    _pool.wait();
+    return replicas;
+}
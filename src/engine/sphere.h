@@ -12,6 +12,18 @@
 #include "engine/ray.h"
 #include "engine/entity.h"
 
+// Geometry of a sphere copied out for BVH leaves, so a leaf's spheres can be tested from one
+// contiguous array without going through each Sphere object
+struct alignas(16) PackedSphere
+{
+    fv3 center; // at time 0, at time t it is center + t * motion
+    f32 sqr_radius;
+    fv3 motion;
+    f32 radius;
+
+    inline fv3 get_center(f32 _time) const;
+};
+
 class Sphere : public Entity
 {
     MOVABLE_ONLY(Sphere);
@@ -21,17 +33,30 @@ public:
     ~Sphere() override = default;
 
     inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Entity::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
     
     inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
     inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
 
+    inline PackedSphere get_packed() const;
+
     static constexpr fv2 get_uv(const fv3& _p);
+    // Nearer root of the sphere's equation inside (_zmin, _zmax), the farther one when the nearer is out
+    static inline b32 find_root(const fv3& _center, f32 _sqr_radius, const Ray& _ray, f32 _zmin, f32 _zmax, f32* root_);
+    static inline b32 has_root(const fv3& _center, f32 _sqr_radius, const Ray& _ray, f32 _zmin, f32 _zmax);
+    static inline void set_hit(const fv3& _center, f32 _radius, Material* _material, const Ray& _ray, f32 _distance, Hit* hit_);
 
 private:
     f32 radius = 0.f;
     f32 sqr_radius = 0.f;
 };
 
+inline fv3 PackedSphere::get_center(f32 _time) const
+{
+    return center + _time * motion;
+}
+
 inline Sphere::Sphere(Transform&& _tf, f32 _radius, Material* _mat)
     : Entity(std::move(_tf), _mat)
     , radius(_radius)
@@ -74,16 +99,30 @@ inline b32 Sphere::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hi
 {
     sws_assert(hit_);
 
+    const fv3 center = transform.get_position(_time);
+    f32 root;
+    if (!find_root(center, sqr_radius, _ray, _zmin, _zmax, &root))
+        return false;
+    set_hit(center, radius, material, _ray, root, hit_);
+    return true;
+}
+
+inline PackedSphere Sphere::get_packed() const
+{
+    return { transform.get_start(), sqr_radius, transform.get_motion(), radius };
+}
+
+inline b32 Sphere::find_root(const fv3& _center, f32 _sqr_radius, const Ray& _ray, f32 _zmin, f32 _zmax, f32* root_)
+{
     // Sphere equations:
     // x*x + y*y + z*z = R*R
     // Dot( p(t)-C, p(t)-C ) = R*R
     // t*t*Dot(B,B) + 2*t*Dot(B,A-C) + Dot(A-C,A-C) - R*R = 0
 
-    const fv3 center = transform.get_position(_time);
-    const fv3 oc = _ray.origin - center;
+    const fv3 oc = _ray.origin - _center;
     const f32 a = math::dot(_ray.direction, _ray.direction);
     const f32 b = math::dot(oc, _ray.direction);
-    const f32 c = math::dot(oc, oc) - sqr_radius;
+    const f32 c = math::dot(oc, oc) - _sqr_radius;
     const f32 d = b*b - a*c;
     if (d > 0.f)
     {
@@ -94,12 +133,39 @@ inline b32 Sphere::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hi
             if (root <= _zmin || root >= _zmax)
                 return false;
         }
-        hit_->distance = root;
-        hit_->point    = _ray.point_at(hit_->distance);
-        hit_->normal   = (hit_->point - center) / radius;
-        hit_->material = material;
-        hit_->uv       = get_uv(hit_->normal);
+        *root_ = root;
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
+
+inline void Sphere::set_hit(const fv3& _center, f32 _radius, Material* _material, const Ray& _ray, f32 _distance, Hit* hit_)
+{
+    hit_->distance = _distance;
+    hit_->point    = _ray.point_at(hit_->distance);
+    hit_->normal   = (hit_->point - _center) / _radius;
+    hit_->material = _material;
+    hit_->uv       = get_uv(hit_->normal);
+}
+
+inline b32 Sphere::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    return has_root(transform.get_position(_time), sqr_radius, _ray, _zmin, _zmax);
+}
+
+inline b32 Sphere::has_root(const fv3& _center, f32 _sqr_radius, const Ray& _ray, f32 _zmin, f32 _zmax)
+{
+    // find_root() without picking one: either root inside the range will do
+    const fv3 oc = _ray.origin - _center;
+    const f32 a = math::dot(_ray.direction, _ray.direction);
+    const f32 b = math::dot(oc, _ray.direction);
+    const f32 c = math::dot(oc, oc) - _sqr_radius;
+    const f32 d = b*b - a*c;
+    if (d <= 0.f)
+        return false;
+
+    const f32 sqrt_d = math::sqrt(d);
+    const f32 near_root = (-b - sqrt_d) / a;
+    const f32 far_root = (-b + sqrt_d) / a;
+    return (near_root > _zmin && near_root < _zmax) || (far_root > _zmin && far_root < _zmax);
+}
@@ -59,19 +59,29 @@ class ImageTexture : public Texture
 {
     NON_COPYABLE(ImageTexture);
 public:
+    // Only records the path, decode() has to run before the texture is sampled.
+    // Lets the frame pipeline decode images while the rest of the scene builds.
+    struct Deferred {};
+
     inline ImageTexture(const char* _filepath);
     inline ImageTexture(const fs::path& _filepath);
+    inline ImageTexture(const fs::path& _filepath, Deferred);
     inline ImageTexture(ImageTexture&& _other) noexcept;
     constexpr ImageTexture& operator=(ImageTexture&& _other) noexcept;
     virtual inline ~ImageTexture();
 
+    inline b32 decode();
+    constexpr b32 is_decoded() const;
+    inline const fs::path& get_filepath() const;
+
     fv3 value(const fv2& _uv, const fv3& _p) const override;
 
 private:
+    fs::path m_filepath;
     uchar* m_data = nullptr;
-    s32 m_width;
-    s32 m_height;
-    s32 m_bpp;
+    s32 m_width = 0;
+    s32 m_height = 0;
+    s32 m_bpp = 0;
 };
 
 // CheckerTexture //
@@ -129,18 +139,25 @@ inline fv3 NoiseTexture::value(const fv2& _uv, const fv3& _p) const
 // ImageTexture //
 
 inline ImageTexture::ImageTexture(const char* _filepath)
-    : m_data(stbi_load(_filepath, &m_width, &m_height, &m_bpp, 0))
+    : ImageTexture(fs::path(_filepath))
 {
-    sws_assert(m_data);
 }
 
 inline ImageTexture::ImageTexture(const fs::path& _filepath)
-    : ImageTexture(_filepath.string().c_str())
+    : ImageTexture(_filepath, Deferred {})
+{
+    decode();
+    sws_assert(m_data);
+}
+
+inline ImageTexture::ImageTexture(const fs::path& _filepath, Deferred)
+    : m_filepath(_filepath)
 {
 }
 
 inline ImageTexture::ImageTexture(ImageTexture&& _other) noexcept
-    : m_data(std::exchange(_other.m_data, nullptr))
+    : m_filepath(std::move(_other.m_filepath))
+    , m_data(std::exchange(_other.m_data, nullptr))
     , m_width(_other.m_width)
     , m_height(_other.m_height)
     , m_bpp(_other.m_bpp)
@@ -151,6 +168,7 @@ inline constexpr ImageTexture& ImageTexture::operator=(ImageTexture&& _other) no
 {
     if (this != std::addressof(_other))
     {
+        m_filepath = std::move(_other.m_filepath);
         m_data = std::exchange(_other.m_data, nullptr);
         m_width = _other.m_width;
         m_height = _other.m_height;
@@ -164,6 +182,23 @@ inline ImageTexture::~ImageTexture()
     util::safe_del(m_data);
 }
 
+inline b32 ImageTexture::decode()
+{
+    if (!m_data)
+        m_data = stbi_load(m_filepath.string().c_str(), &m_width, &m_height, &m_bpp, 0);
+    return m_data != nullptr;
+}
+
+inline constexpr b32 ImageTexture::is_decoded() const
+{
+    return m_data != nullptr;
+}
+
+inline const fs::path& ImageTexture::get_filepath() const
+{
+    return m_filepath;
+}
+
 inline fv3 ImageTexture::value(const fv2& _uv, const fv3& _p) const
 {
     s32 i = s32(m_width * _uv.u);
@@ -20,6 +20,12 @@ public:
     explicit inline Transform(const fv3& _start, const fv3& _end);
 
     inline fv3 get_position(f32 _time) const;
+    // get_position(t) is get_start() + t * get_motion(), the motion is zero when static
+    inline const fv3& get_start() const;
+    inline fv3 get_motion() const;
+
+    // Animation between frames: moves the whole path, the motion over the shutter is kept
+    inline void set_position(const fv3& _pos);
 
 private:
     fv3 m_start;
@@ -44,3 +50,18 @@ inline fv3 Transform::get_position(f32 _time) const
 {
     return (m_is_static) ? m_start : (m_start + _time * m_target_offset);
 };
+
+inline const fv3& Transform::get_start() const
+{
+    return m_start;
+}
+
+inline fv3 Transform::get_motion() const
+{
+    return (m_is_static) ? fv3(0.f) : m_target_offset;
+}
+
+inline void Transform::set_position(const fv3& _pos)
+{
+    m_start = _pos;
+}
@@ -0,0 +1,403 @@
+// ======================================================================
+// File: widebvh.h
+// Revision: 1.0
+// Creation: 10/17/2026 - jsberbel
+// Notice: Copyright © 2026 by Jordi Serrano Berbel. All Rights Reserved.
+// ======================================================================
+
+#pragma once
+
+#include "core/utils.h"
+#include "core/math/aabb.h"
+
+#include "engine/bvh.h"
+#include "engine/hitable.h"
+#include "engine/ray.h"
+
+#include <limits>
+#include <vector>
+
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// BVH with _width (4 or 8) children per node, collapsed from a binary BVH by repeatedly
+// opening the largest interior child. Child bounds are stored as SoA rows so a single
+// SSE (4) or AVX (8) slab test checks every child; without AVX an 8-wide node is tested
+// as two SSE halves. Hit children are visited nearest first and popped entries farther
+// than the closest hit are skipped.
+template <u32 _width>
+class WideBVH : public Hitable
+{
+    NON_COPYABLE(WideBVH);
+    static_assert(_width == 4u || _width == 8u);
+
+public:
+    struct alignas(32) Node
+    {
+        f32 bounds[6][_width];      // min x, y, z then max x, y, z; empty lanes never hit
+        u32 offsets[_width];        // interior child: node index, leaf: first primitive
+        u32 nb_primitives[_width];  // 0 for interior children and empty lanes
+    };
+
+public:
+    inline WideBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings = {});
+    inline WideBVH(const BVH& _bvh, f32 _t0, f32 _t1);
+
+    inline b32 hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const override;
+    using Hitable::occluded;
+    inline b32 occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const override;
+    inline b32 compute_aabb(f32 _time, AABB* aabb_) const override;
+    inline b32 compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const override;
+
+    // Same metric as BVH::get_sah_cost
+    inline f32 get_sah_cost(f32 _traversal_cost = BVHSettings {}.traversal_cost) const;
+    inline u32 get_nb_nodes() const;
+
+    // Slab test of every lane of _node, bit i set when child i is hit. Matches AABB::is_hit
+    // lane by lane, tnear_ receives each child's entry distance. The ray's sign picks the
+    // near and far bound rows, so no per-lane min/max is needed.
+    static inline u32 intersect(const Node& _node, const Ray& _ray, f32 _tmin, f32 _tmax, f32* tnear_);
+
+    // Sets lane _lane of _node to the given box, or to the never-hit box for nullptr
+    static inline void set_lane(Node* node_, u32 _lane, const AABB* _bounds);
+
+private:
+    // Every level pushes at most _width - 1 entries on top of the one it popped. The stack for
+    // this many levels is on the call stack, deeper trees use a heap one
+    static constexpr u32 k_stack_depth = 64u;
+    static constexpr u32 k_stack_size = k_stack_depth * (_width - 1u) + 1u;
+
+    struct StackEntry
+    {
+        u32 offset;
+        u32 nb_primitives;
+        f32 tnear;
+    };
+
+    inline void collapse(const BVH& _bvh, f32 _t0, f32 _t1);
+    inline u32 collapse_node(const BVH& _bvh, f32 _t0, f32 _t1, u32 _depth);
+    inline usize get_heap_stack_size() const;
+
+    static inline u32 intersect_sse(const Node& _node, u32 _first_lane, const Ray& _ray, f32 _tmin, f32 _tmax, f32* tnear_);
+
+private:
+    std::vector<Node> m_nodes;
+    std::vector<Hitable*> m_primitives;
+    AABB m_aabb;
+    u32 m_depth = 0u;
+};
+
+template <u32 _width>
+inline WideBVH<_width>::WideBVH(Hitable** _hitables, u32 _nb_hitables, f32 _t0, f32 _t1, const BVHSettings& _settings)
+{
+    collapse(BVH(_hitables, _nb_hitables, _t0, _t1, _settings), _t0, _t1);
+}
+
+template <u32 _width>
+inline WideBVH<_width>::WideBVH(const BVH& _bvh, f32 _t0, f32 _t1)
+{
+    collapse(_bvh, _t0, _t1);
+}
+
+template <u32 _width>
+inline void WideBVH<_width>::collapse(const BVH& _bvh, f32 _t0, f32 _t1)
+{
+    m_nodes.clear();
+    m_primitives.clear();
+    m_aabb = _bvh.aabb;
+    m_depth = 0u;
+    collapse_node(_bvh, _t0, _t1, 1u);
+}
+
+template <u32 _width>
+inline usize WideBVH<_width>::get_heap_stack_size() const
+{
+    return (m_depth > k_stack_depth) ? usize(m_depth) * (_width - 1u) + 1u : 0u;
+}
+
+template <u32 _width>
+inline u32 WideBVH<_width>::collapse_node(const BVH& _bvh, f32 _t0, f32 _t1, u32 _depth)
+{
+    m_depth = math::max(m_depth, _depth);
+
+    // An interior binary child is one that still splits; a BVH pointing twice at the same primitive is a leaf
+    auto get_interior = [](const Hitable* _hitable) -> const BVH*
+    {
+        const BVH* bvh = dynamic_cast<const BVH*>(_hitable);
+        return (bvh && bvh->left != bvh->right) ? bvh : nullptr;
+    };
+
+    std::vector<const Hitable*> children = { _bvh.left };
+    if (_bvh.right != _bvh.left)
+        children.push_back(_bvh.right);
+
+    // Open the largest interior child until the node is full: big boxes are the ones most rays enter
+    while (children.size() < _width)
+    {
+        usize largest = children.size();
+        f32 largest_area = -1.f;
+        for (usize idx = 0u; idx < children.size(); ++idx)
+        {
+            const BVH* interior = get_interior(children[idx]);
+            if (interior && interior->aabb.get_surface_area() > largest_area)
+            {
+                largest = idx;
+                largest_area = interior->aabb.get_surface_area();
+            }
+        }
+        if (largest == children.size())
+            break;
+
+        const BVH* opened = get_interior(children[largest]);
+        children[largest] = opened->left;
+        children.push_back(opened->right);
+    }
+
+    const u32 node_idx = u32(m_nodes.size());
+    m_nodes.emplace_back();
+    for (u32 lane = 0u; lane < _width; ++lane)
+        set_lane(&m_nodes[node_idx], lane, nullptr);
+
+    for (u32 lane = 0u; lane < u32(children.size()); ++lane)
+    {
+        const Hitable* child = children[lane];
+        AABB bounds;
+        child->compute_aabb(_t0, _t1, &bounds);
+
+        // Children are appended after the parent, m_nodes may reallocate: index, never hold a reference
+        u32 offset = u32(m_primitives.size());
+        u32 nb_primitives = 0u;
+        if (const BVH* interior = get_interior(child))
+        {
+            offset = collapse_node(*interior, _t0, _t1, _depth + 1u);
+        }
+        else if (const BVHLeaf* leaf = dynamic_cast<const BVHLeaf*>(child))
+        {
+            m_primitives.insert(m_primitives.end(), leaf->get_hitables().begin(), leaf->get_hitables().end());
+            nb_primitives = leaf->get_size();
+        }
+        else
+        {
+            const BVH* single = dynamic_cast<const BVH*>(child);
+            m_primitives.push_back(const_cast<Hitable*>(single ? single->left : child));
+            nb_primitives = 1u;
+        }
+
+        set_lane(&m_nodes[node_idx], lane, &bounds);
+        m_nodes[node_idx].offsets[lane] = offset;
+        m_nodes[node_idx].nb_primitives[lane] = nb_primitives;
+    }
+    return node_idx;
+}
+
+template <u32 _width>
+inline void WideBVH<_width>::set_lane(Node* node_, u32 _lane, const AABB* _bounds)
+{
+    // (+inf, +inf) fails every slab whatever the ray direction sign, no validity mask needed
+    constexpr f32 k_inf = std::numeric_limits<f32>::infinity();
+    for (u32 axis = 0u; axis < 3u; ++axis)
+    {
+        node_->bounds[axis][_lane]      = _bounds ? _bounds->min[axis] : k_inf;
+        node_->bounds[axis + 3u][_lane] = _bounds ? _bounds->max[axis] : k_inf;
+    }
+    node_->offsets[_lane] = 0u;
+    node_->nb_primitives[_lane] = 0u;
+}
+
+template <u32 _width>
+inline b32 WideBVH<_width>::hit(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax, Hit* hit_) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    StackEntry local_stack[k_stack_size];
+    std::vector<StackEntry> heap_stack(get_heap_stack_size());
+    StackEntry* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    stack[stack_size++] = { 0u, 0u, _zmin };
+
+    b32 has_hit_anything = false;
+    f32 closest_dist = _zmax;
+    u32 nb_visits = 0u;
+    while (stack_size > 0u)
+    {
+        const StackEntry entry = stack[--stack_size];
+        // Entered beyond the closest hit found since it was pushed
+        if (entry.tnear >= closest_dist)
+            continue;
+
+        if (entry.nb_primitives > 0u)
+        {
+            for (u32 idx = entry.offset; idx < entry.offset + entry.nb_primitives; ++idx)
+            {
+                Hit tmp_hit;
+                if (m_primitives[idx]->hit(_ray, _time, _zmin, closest_dist, &tmp_hit))
+                {
+                    has_hit_anything = true;
+                    closest_dist = tmp_hit.distance;
+                    *hit_ = std::move(tmp_hit);
+                }
+            }
+            continue;
+        }
+
+        const Node& node = m_nodes[entry.offset];
+        ++nb_visits;
+        f32 tnear[_width];
+        u32 mask = intersect(node, _ray, _zmin, closest_dist, tnear);
+
+        // Insertion sort of the hit lanes by distance, farthest first so the nearest is popped next
+        const u32 first = stack_size;
+        for (; mask != 0u; mask &= mask - 1u)
+        {
+            u32 lane = 0u;
+            while (!(mask & (1u << lane)))
+                ++lane;
+
+            const StackEntry child = { node.offsets[lane], node.nb_primitives[lane], tnear[lane] };
+            u32 pos = stack_size++;
+            for (; pos > first && stack[pos - 1u].tnear < child.tnear; --pos)
+                stack[pos] = stack[pos - 1u];
+            stack[pos] = child;
+        }
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return has_hit_anything;
+}
+
+template <u32 _width>
+inline b32 WideBVH<_width>::occluded(const Ray& _ray, f32 _time, f32 _zmin, f32 _zmax) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    // Hit lanes are pushed as they come, the first hit ends the query so nothing is sorted
+    StackEntry local_stack[k_stack_size];
+    std::vector<StackEntry> heap_stack(get_heap_stack_size());
+    StackEntry* stack = heap_stack.empty() ? local_stack : heap_stack.data();
+    u32 stack_size = 0u;
+    stack[stack_size++] = { 0u, 0u, _zmin };
+
+    u32 nb_visits = 0u;
+    b32 is_occluded = false;
+    while (stack_size > 0u && !is_occluded)
+    {
+        const StackEntry entry = stack[--stack_size];
+        if (entry.nb_primitives > 0u)
+        {
+            for (u32 idx = entry.offset; idx < entry.offset + entry.nb_primitives && !is_occluded; ++idx)
+                is_occluded = m_primitives[idx]->occluded(_ray, _time, _zmin, _zmax);
+            continue;
+        }
+
+        const Node& node = m_nodes[entry.offset];
+        ++nb_visits;
+        f32 tnear[_width];
+        for (u32 mask = intersect(node, _ray, _zmin, _zmax, tnear); mask != 0u; mask &= mask - 1u)
+        {
+            u32 lane = 0u;
+            while (!(mask & (1u << lane)))
+                ++lane;
+            stack[stack_size++] = { node.offsets[lane], node.nb_primitives[lane], tnear[lane] };
+        }
+    }
+    BVHTraversalStats::add_node_visits(nb_visits);
+    return is_occluded;
+}
+
+template <u32 _width>
+inline u32 WideBVH<_width>::intersect(const Node& _node, const Ray& _ray, f32 _tmin, f32 _tmax, f32* tnear_)
+{
+#if defined(__AVX__)
+    if constexpr (_width == 8u)
+    {
+        __m256 tmin = _mm256_set1_ps(_tmin);
+        __m256 tmax = _mm256_set1_ps(_tmax);
+        for (u32 axis = 0u; axis < 3u; ++axis)
+        {
+            const u32 near_row = axis + 3u * _ray.sign[axis];
+            const u32 far_row = axis + 3u * (1u - _ray.sign[axis]);
+            const __m256 inv_dir = _mm256_set1_ps(_ray.inv_direction[axis]);
+            const __m256 origin = _mm256_set1_ps(_ray.slab_origin[axis]);
+            tmin = _mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(_node.bounds[near_row]), origin), inv_dir), tmin);
+            tmax = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(_node.bounds[far_row]), origin), inv_dir), tmax);
+        }
+        _mm256_storeu_ps(tnear_, tmin);
+        return u32(_mm256_movemask_ps(_mm256_cmp_ps(tmin, tmax, _CMP_LT_OQ)));
+    }
+#endif
+
+    u32 mask = 0u;
+    for (u32 lane = 0u; lane < _width; lane += 4u)
+        mask |= intersect_sse(_node, lane, _ray, _tmin, _tmax, tnear_ + lane) << lane;
+    return mask;
+}
+
+template <u32 _width>
+inline u32 WideBVH<_width>::intersect_sse(const Node& _node, u32 _first_lane, const Ray& _ray, f32 _tmin, f32 _tmax, f32* tnear_)
+{
+    // The ray's reciprocal is finite: real boxes never produce NaN, empty lanes (+inf rows)
+    // give +inf entries or -inf exits and always miss
+    __m128 tmin = _mm_set1_ps(_tmin);
+    __m128 tmax = _mm_set1_ps(_tmax);
+    for (u32 axis = 0u; axis < 3u; ++axis)
+    {
+        const u32 near_row = axis + 3u * _ray.sign[axis];
+        const u32 far_row = axis + 3u * (1u - _ray.sign[axis]);
+        const __m128 inv_dir = _mm_set1_ps(_ray.inv_direction[axis]);
+        const __m128 origin = _mm_set1_ps(_ray.slab_origin[axis]);
+        tmin = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(&_node.bounds[near_row][_first_lane]), origin), inv_dir), tmin);
+        tmax = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(_mm_load_ps(&_node.bounds[far_row][_first_lane]), origin), inv_dir), tmax);
+    }
+    _mm_storeu_ps(tnear_, tmin);
+    return u32(_mm_movemask_ps(_mm_cmplt_ps(tmin, tmax)));
+}
+
+template <u32 _width>
+inline b32 WideBVH<_width>::compute_aabb(f32 _time, AABB* aabb_) const
+{
+    *aabb_ = m_aabb;
+    return !m_nodes.empty();
+}
+
+template <u32 _width>
+inline b32 WideBVH<_width>::compute_aabb(f32 _t0, f32 _t1, AABB* aabb_) const
+{
+    *aabb_ = m_aabb;
+    return !m_nodes.empty();
+}
+
+template <u32 _width>
+inline f32 WideBVH<_width>::get_sah_cost(f32 _traversal_cost) const
+{
+    const f32 root_area = m_aabb.get_surface_area();
+    if (m_nodes.empty() || root_area <= 0.f)
+        return 0.f;
+
+    // Interior nodes are charged at their own bounds, the union of their lanes
+    f64 cost = _traversal_cost * root_area;
+    for (const Node& node : m_nodes)
+    {
+        for (u32 lane = 0u; lane < _width; ++lane)
+        {
+            if (node.bounds[0][lane] == std::numeric_limits<f32>::infinity())
+                continue;
+            const AABB bounds(fv3(node.bounds[0][lane], node.bounds[1][lane], node.bounds[2][lane]),
+                              fv3(node.bounds[3][lane], node.bounds[4][lane], node.bounds[5][lane]));
+            const u32 nb_primitives = node.nb_primitives[lane];
+            cost += bounds.get_surface_area() * ((nb_primitives == 0u) ? _traversal_cost : f32(nb_primitives));
+        }
+    }
+    return f32(cost / root_area);
+}
+
+template <u32 _width>
+inline u32 WideBVH<_width>::get_nb_nodes() const
+{
+    return u32(m_nodes.size());
+}
+
+using BVH4 = WideBVH<4u>;
+using BVH8 = WideBVH<8u>;
@@ -5,166 +5,351 @@
 // Notice: Copyright  2018 by Jordi Serrano Berbel. All Rights Reserved.
 // ======================================================================
 
+#include "core/args.h"
+#include "core/rng.h"
 #include "core/utils.h"
 #include "core/profiler.h"
+#include "core/taskgraph.h"
+#include "core/threadpool.h"
 
-#include "engine/hitablelist.h"
-#include "engine/sphere.h"
-#include "engine/bvh.h"
 #include "engine/camera.h"
-#include "engine/material.h"
+#include "engine/framebuffer.h"
+#include "engine/golden.h"
+#include "engine/imagewriter.h"
+#include "engine/renderer.h"
+#include "engine/renderfarm.h"
+#include "engine/scenes.h"
 
-#include <vector>
+#include "bench/benchmarks.h"
 
-constexpr fv3 background_color(const Ray& _ray)
+inline s32 check_golden(const Args& _args, const Framebuffer& _framebuffer, const std::string& _scene, const RenderSettings& _settings)
 {
-    const fv3 unit_dir = _ray.direction.get_normalized();
-    const f32 t = 0.5f * (unit_dir.y + 1.f);
-    return math::lerp(fv3(1.f), fv3(.5f, .7f, 1.f), t);
-}
-
-inline fv3 generate_color(const Ray& _ray, Hitable* _world, f32 _time, s32 _depth)
-{
-    if (Hit hit; _world->hit(_ray, _time, 0.001f, std::numeric_limits<f32>::max(), &hit))
+    s32 exit_code = 0;
+    const fs::path golden_path = golden::get_default_path(_scene + "_" + std::to_string(_settings.width) + "x" + std::to_string(_settings.height) +
+                                                          "_" + std::to_string(_settings.nb_samples) + "spp_" + std::to_string(_settings.seed));
+    if (_args.has("--golden-write"))
     {
-        Ray scattered;
-        fv3 attenuation;
-        if (_depth < 50 && hit.material->scatter(_ray, hit, &attenuation, &scattered))
-            return attenuation * generate_color(scattered, _world, _time, _depth + 1);
-
-        return fv3::zero();
+        const fs::path path = _args.get_str("--golden-write", golden_path.string());
+        const b32 is_written = golden::write(_framebuffer, path);
+        util::output_to_console("Golden image %s: %s", is_written ? "written" : "NOT written", path.string().c_str());
+        exit_code = is_written ? exit_code : 1;
     }
-    return background_color(_ray);
+    if (_args.has("--golden-check"))
+    {
+        const fs::path path = _args.get_str("--golden-check", golden_path.string());
+        const golden::Result result = golden::compare(_framebuffer, path);
+        if (result.matches)
+            util::output_to_console("Golden check passed: %s", path.string().c_str());
+        else if (!result.error.empty())
+            util::output_to_console("Golden check FAILED: %s", result.error.c_str());
+        else
+            util::output_to_console("Golden check FAILED: %u pixels differ (max channel diff %u) from %s",
+                                    result.nb_diff_pixels, result.max_channel_diff, path.string().c_str());
+        exit_code = result.matches ? exit_code : 1;
+    }
+    return exit_code;
 }
 
-inline fv3 correct_gamma(const fv3& _color)
+// Sidecar of every written image, records what the frame actually got (e.g. the spp reached in time budget)
+inline std::string get_metadata(const RenderSettings& _settings, const std::string& _scene, const RenderStats& _stats)
 {
-    // Formula: Vout = A * pow( Vin, y ) with A = 1 and y = 1/2
-    return fv3(math::sqrt(_color.x), math::sqrt(_color.y), math::sqrt(_color.z));
+    std::stringstream json;
+    json << "{\n"
+         << "    \"scene\": \"" << _scene << "\",\n"
+         << "    \"width\": " << _settings.width << ",\n"
+         << "    \"height\": " << _settings.height << ",\n"
+         << "    \"seed\": " << _settings.seed << ",\n"
+         << "    \"samples_per_pixel\": " << _stats.nb_samples << ",\n"
+         << "    \"passes\": " << _stats.nb_passes << ",\n"
+         << "    \"time_budget_seconds\": " << _settings.time_budget_seconds << ",\n"
+         << "    \"render_seconds\": " << _stats.seconds << ",\n"
+         << "    \"rays\": " << _stats.nb_rays << "\n"
+         << "}\n";
+    return json.str();
 }
 
-inline Hitable* generate_rand_world()
+// Animation batches orbit the camera around the look-at point, one turn over all frames
+inline Camera get_frame_camera(const RenderSettings& _settings, u32 _frame, u32 _nb_frames)
 {
-    constexpr u32 size = 50000;
-    HitableList* list = new HitableList(size);
+    constexpr fv3 look_from(13.f, 2.f, -8.f);
+    constexpr fv3 look_at(0.f, 0.f, 0.f);
+    constexpr f32 v_FOV = 25.f;
+    constexpr f32 aperture = 0.f;
 
-    Texture* checker = new CheckerTexture(new ConstTexture(fv3(0.2f, 0.3f, 0.1f)), new ConstTexture(fv3(0.9f, 0.9f, 0.9f)));
-    list->add(new Sphere(Transform(fv3(0.f, -1000.f, 0.f)), 1000.f, new Lambertian(checker)));
+    const f32 angle = math::Pi2<f32> * f32(_frame) / f32(_nb_frames);
+    const fv3 offset = look_from - look_at;
+    const fv3 frame_look_from = look_at + fv3(offset.x * math::cos(angle) - offset.z * math::sin(angle), offset.y,
+                                              offset.x * math::sin(angle) + offset.z * math::cos(angle));
+    return Camera(frame_look_from, look_at, _settings.width, _settings.height, v_FOV, aperture);
+}
 
-    for (s32 a = -10; a < 10; ++a)
-    {
-        for (s32 b = -10; b < 10; ++b)
-        {
-            const f32 mat_to_choose = util::frand_01();
-            const fv3 center(a + 0.9f * util::frand_01(), 0.2f, b + 0.9f * util::frand_01());
+// Worker process of the render farm, spawned by run_farm() with the coordinator's command line
+inline s32 run_farm_worker(const Args& _args, const RenderSettings& _settings, const std::string& _scene, u32 _grid_extent,
+                           const BVHSettings& _bvh_settings)
+{
+    ThreadPool pool(1u);
+    Renderer renderer(pool, _settings);
+    Hitable* world = generate_scene(_scene, _settings.seed, nullptr, _grid_extent, _bvh_settings);
 
-            if ((center - fv3(4.f, 0.2f, 0.f)).get_length() > 0.9f)
-            {
-                if (mat_to_choose < 0.8f) // Diffuse
-                {
-                    auto rnd_sqr_unit = []() constexpr { return util::frand_01() * util::frand_01(); };
-                    Transform tf(center, center + fv3(0.f, 0.5f * util::frand_01(), 0.f));
-                    Material* mt = new Lambertian(new ConstTexture(fv3(rnd_sqr_unit(), rnd_sqr_unit(), rnd_sqr_unit())));
-                    list->add(new Sphere(std::move(tf), 0.2f, mt));
-                }
-                else if (mat_to_choose < 0.95f) // Metal
-                {
-                    auto rnd_half_unit = []() constexpr { return 0.5f * (1.f + util::frand_01()); };
-                    Transform tf(center);
-                    Material* mt = new Metal(fv3(rnd_half_unit(), rnd_half_unit(), rnd_half_unit()), 0.5f * util::frand_01());
-                    list->add(new Sphere(std::move(tf), 0.2f, mt));
-                }
-                else // Glass
-                {
-                    Transform tf(center);
-                    list->add(new Sphere(std::move(tf), 0.2f, new Dielectric(1.5f)));
-                }
-            }
-        }
+    // Fault injection only ever hits the first worker, the others have to cover for it
+    const u32 worker_idx = _args.get_u32("--farm-worker-index", 0u);
+    farm::WorkerFaults faults;
+    if (worker_idx == 0u)
+    {
+        faults.slow_ms = _args.get_u32("--farm-slow-ms", 0u);
+        faults.exit_after = _args.get_u32("--farm-fault-after", 0u);
     }
-    
-    list->add(new Sphere(Transform(fv3(0.f, 1.f, 0.f)),  1.f, new Dielectric(1.5f)));
-    list->add(new Sphere(Transform(fv3(-4.f, 1.f, 0.f)), 1.f, new Lambertian(new ConstTexture(fv3(0.4f, 0.2f, 0.1f)))));
-    list->add(new Sphere(Transform(fv3(4.f, 1.f, 0.f)),  1.f, new Metal(fv3(0.7f, 0.2f, 0.5f), 0.f)));
-    
-    return new BVH(list->get_buffer(), list->get_size(), 0.0, 1.0);
-    return list;
+
+    const s32 exit_code = farm::run_worker(_args.get_str("--farm-worker", ""), worker_idx, renderer, get_frame_camera(_settings, 0u, 1u),
+                                           world, faults);
+    util::safe_del(world);
+    return exit_code;
 }
 
-inline Hitable* generate_perlin_spheres()
+// Still image rendered by local worker processes instead of threads
+inline s32 run_farm(const Args& _args, const RenderSettings& _settings, const std::string& _scene)
 {
-    Texture* t1 = new NoiseTexture(1);
-    Texture* t2 = new ImageTexture(util::get_data_path() / "earth_daymap.jpg");
-    HitableList* list = new HitableList(2);
-    list->add(new Sphere(Transform(fv3(0.f, -1000.f, 0.f)), 1000.f, new Lambertian(t1)));
-    list->add(new Sphere(Transform(fv3(0.f, 2.f, 0.f)), 2.f, new Lambertian(t2)));
-    return list;
+    farm::Settings farm_settings;
+    farm_settings.nb_workers = _args.get_u32("--farm", 0u);
+    farm_settings.max_in_flight = math::max(_args.get_u32("--farm-in-flight", farm_settings.max_in_flight), 1u);
+    // The explicit seed comes first so every worker builds the same scene as the coordinator
+    char seed[32];
+    std::snprintf(seed, sizeof(seed), "0x%llx", _settings.seed);
+    farm_settings.worker_args = { "--seed", seed };
+    farm_settings.worker_args.insert(farm_settings.worker_args.end(), _args.get_all().begin() + 1, _args.get_all().end());
+
+    ThreadPool pool(1u);
+    const Renderer renderer(pool, _settings);
+    Framebuffer framebuffer(_settings.width, _settings.height);
+    farm::Stats stats;
+    if (!farm::run_coordinator(farm_settings, renderer.generate_tiles(), &framebuffer, &stats))
+        return 1;
+    stats.print();
+
+    const std::string name = util::get_time_of_day();
+    util::output_img_to_file(name, _settings.width, _settings.height, framebuffer.get_data());
+    return check_golden(_args, framebuffer, _scene, _settings);
 }
 
-int main()
+int main(s32 _argc, utf8** _argv)
 {
+    const Args args(_argc, _argv);
+    if (args.has("--bench"))
+        return bench::run(args);
+
+    s32 exit_code = 0;
+
     PROFILER_BATCH_START(1);
 
-    constexpr u32 width = 600;
-    constexpr u32 height = 480;
-    constexpr u32 nb_samples = 30;
+    RenderSettings settings;
+    settings.width      = args.get_u32("--width", 600u);
+    settings.height     = args.get_u32("--height", 480u);
+    settings.nb_samples = args.get_u32("--samples", 30u);
+    settings.tile_size  = args.get_u32("--tile", 16u);
+    settings.progress_interval_ms = args.get_u32("--progress-ms", settings.progress_interval_ms);
+    settings.use_perf_counters = args.has("--perf-counters");
+    settings.time_budget_seconds = args.get_f64("--time-budget", 0.);
+    settings.samples_per_pass = args.get_u32("--samples-per-pass", settings.samples_per_pass);
+    if (!parse_tile_order(args.get_str("--tile-order", get_name(settings.tile_order)), &settings.tile_order) ||
+        !parse_pixel_order(args.get_str("--pixel-order", get_name(settings.pixel_order)), &settings.pixel_order))
+    {
+        util::output_to_console("Unknown traversal order, expected --tile-order scanline|morton|hilbert and --pixel-order scanline|morton");
+        return 1;
+    }
 
-    std::vector<rgb> data;
-    data.reserve(width * height);
+    BVHSettings bvh_settings;
+    bvh_settings.max_leaf_size = math::max(args.get_u32("--bvh-leaf", bvh_settings.max_leaf_size), 1u);
+    bvh_settings.max_time_splits = args.get_u32("--bvh-time-splits", bvh_settings.max_time_splits);
+    bvh_settings.rebuild_ratio = f32(args.get_f64("--bvh-rebuild-ratio", bvh_settings.rebuild_ratio));
+    bvh_settings.outlier_area_ratio = math::max(f32(args.get_f64("--bvh-outlier-ratio", bvh_settings.outlier_area_ratio)), 0.f);
+    if (!parse_bvh_builder(args.get_str("--bvh", get_name(bvh_settings.builder)), &bvh_settings.builder) ||
+        !parse_bvh_layout(args.get_str("--bvh-layout", get_name(bvh_settings.layout)), &bvh_settings.layout) ||
+        !parse_bvh_traversal(args.get_str("--bvh-traversal", get_name(bvh_settings.traversal)), &bvh_settings.traversal))
+    {
+        util::output_to_console("Unknown BVH option, expected --bvh median|sah|lbvh, --bvh-layout pointer|flat|bvh4|bvh8|motion "
+                                "and --bvh-traversal ordered|unordered");
+        return 1;
+    }
 
-    //Hitable* world = generate_rnd_world();
-    Hitable* world = generate_perlin_spheres();
+    // Deterministic mode: every random decision (scene, BVH, camera, bounces) derives from
+    // the seed, so the image is the same bytes whatever the thread count
+    const b32 is_deterministic = args.has("--deterministic") || args.has("--seed") ||
+                                 args.has("--golden-check") || args.has("--golden-write");
+    settings.seed = is_deterministic ? args.get_u64("--seed", settings.seed)
+                                     : (u64(std::random_device{}()) << 32u) | std::random_device{}();
+    util::output_to_console("Seed: 0x%llx%s", settings.seed, is_deterministic ? " (deterministic)" : "");
 
-    constexpr fv3 look_from(13.f, 2.f, -8.f);
-    constexpr fv3 look_at(0.f, 0.f, 0.f);
-    constexpr f32 v_FOV = 25.f;
-    constexpr f32 aperture = 0.f;
-    Camera camera(look_from, look_at, width, height, v_FOV, aperture);
+    const std::string scene = args.get_str("--scene", "perlin");
+    const u32 grid_extent = args.get_u32("--grid", 10u);
+
+    if (args.has("--farm-worker"))
+        return run_farm_worker(args, settings, scene, grid_extent, bvh_settings);
+    if (args.has("--farm"))
+        return run_farm(args, settings, scene);
+
+    // NUMA mode: workers pinned per node, each node first-touches its band of the framebuffer
+    // and, with --numa-replicate, traces its own copy of the scene
+    const b32 is_numa = args.has("--numa") || args.has("--numa-replicate");
+    ThreadPool pool = is_numa ? ThreadPool(numa::get_topology(), args.get_u32("--threads", 0u)) : ThreadPool(args.get_u32("--threads", 0u));
+    if (is_numa)
+        util::output_to_console("NUMA: %u threads pinned over %u nodes", pool.get_nb_threads(), pool.get_nb_nodes());
+
+    // The SAH build bins its top levels and forks its subtrees on the render pool, idle until the first frame
+    BVHBuildStats bvh_build_stats;
+    bvh_settings.pool = &pool;
+    bvh_settings.build_stats = args.has("--bvh-stats") ? &bvh_build_stats : nullptr;
+    BVHTraversalStats::set_enabled(args.has("--bvh-stats"));
+
+    // A flat tree from an earlier run of the same scene and settings is mapped instead of built
+    BVHCacheStats bvh_cache_stats;
+    bvh_settings.cache_dir = args.get_str("--bvh-cache", "");
+    bvh_settings.cache_stats = &bvh_cache_stats;
 
     /*constexpr f32 start_time = 0.f;
     constexpr f32 end_time = 1.f;*/
 
     //world.sort_by_distance( camera );
-    
-    constexpr f32 inv_width       = math::inv(f32(width));
-    constexpr f32 inv_height      = math::inv(f32(height));
-    constexpr f32 inv_nb_samples  = math::inv(f32(nb_samples));
-    const f32 sqrt_nb_samples     = math::sqrt(f32(nb_samples));
-    const f32 inv_sqrt_nb_samples = math::inv(sqrt_nb_samples);
-
-    for (s32 y = height - 1; y >= 0; --y)
+
+    const u32 nb_frames = math::max(args.get_u32("--frames", 1u), 1u);
+    const u32 output_queue = math::max(args.get_u32("--output-queue", 2u), 1u);
+    const std::string output_name = util::get_time_of_day();
+
+    Renderer renderer(pool, settings);
+    ImageWriter writer;
+
+    // Frame pipeline as a task graph run by a few stage threads, render tasks hand the tracing
+    // to the render pool. Image decoding overlaps the BVH build and frame N is encoded while
+    // frame N+1 is traced; frame N+queue waits for frame N to be written, which bounds memory.
+    ThreadPool stage_pool(args.get_u32("--stage-threads", 3u));
+    TaskGraph graph;
+
+    // Scene replicas are built once, an animated scene has a single copy
+    const b32 is_animated = args.has("--animate") && !args.has("--numa-replicate");
+    std::unique_ptr<SceneAnimation> animation;
+
+    SceneBuild scene_build;
+    b32 is_scene_ready = true; // false when a texture could not be decoded, nothing is rendered
+    std::vector<Hitable*> worlds;
+    std::vector<const Hitable*> render_worlds;
+    std::vector<TaskGraph::TaskId> scene_tasks;
+    if (args.has("--numa-replicate"))
+    {
+        scene_tasks.push_back(graph.add("build scene replicas", [&]()
+        {
+            worlds = generate_scene_replicas(pool, scene, settings.seed, grid_extent, bvh_settings);
+            render_worlds.assign(worlds.begin(), worlds.end());
+        }));
+    }
+    else
     {
-        for (s32 x = 0; x < s32(width); ++x)
+        const TaskGraph::TaskId primitives = graph.add("build primitives", [&]() { scene_build = build_scene_primitives(scene, settings.seed, &pool, grid_extent); });
+        scene_tasks.push_back(graph.add("build bvh", [&]()
+        {
+            build_scene_bvh(&scene_build, bvh_settings, is_animated);
+            if (is_animated)
+                animation = std::make_unique<SceneAnimation>(scene_build.primitives);
+            if (scene_build.use_bvh)
+                util::output_to_console("BVH (%s builder, %s layout): %u primitives, SAH cost %.4f", get_name(bvh_settings.builder),
+                                        get_name(bvh_settings.layout), scene_build.primitives->get_size(),
+                                        get_bvh_sah_cost(scene_build.world, bvh_settings.traversal_cost));
+            if (const OutlierBVH* outlier_bvh = dynamic_cast<const OutlierBVH*>(scene_build.world))
+                util::output_to_console("BVH: %u primitives kept out of the tree (unbounded or outsized)", u32(outlier_bvh->get_outliers().size()));
+            if (scene_build.use_bvh && bvh_settings.build_stats && bvh_settings.builder == BVHBuilder::SAH && !bvh_cache_stats.is_hit)
+                bvh_build_stats.print();
+            if (scene_build.use_bvh && !is_animated && !bvh_settings.cache_dir.empty() && bvh_settings.layout == BVHLayout::Flat)
+                bvh_cache_stats.print();
+            worlds = { scene_build.world };
+            render_worlds.assign(worlds.begin(), worlds.end());
+        }, { primitives }));
+        scene_tasks.push_back(graph.add("decode textures", [&]()
         {
-            fv3 color = fv3::zero();
-            for (s32 s = 0; s < s32(nb_samples); ++s)
+            for (ImageTexture* texture : scene_build.textures)
             {
-                const f32 sx    = f32(std::fmod(s, sqrt_nb_samples)) * inv_sqrt_nb_samples; // util::frand_01()
-                const f32 sy    = u32(s / sqrt_nb_samples) * inv_sqrt_nb_samples; // util::frand_01()
-                const f32 u     = (x + sx) * inv_width;
-                const f32 v     = (y + sy) * inv_height;
-                const Ray ray   = camera.trace_ray(u, v);
-                const f32 time  = f32(s) * inv_nb_samples; //util::frand_01();
-                const s32 depth = 0;
-                color += generate_color(ray, world, time, depth);
+                if (texture->decode())
+                    continue;
+                util::output_to_console("Texture: could not decode %s", texture->get_filepath().string().c_str());
+                is_scene_ready = false;
+                exit_code = 1;
             }
-            color /= nb_samples;
-            color = correct_gamma(color);
+        }, { primitives }));
+    }
 
-            const rgb rgb((255.99f * color).cast<u8>());
-            data.push_back(rgb);
-        }
+    std::vector<std::unique_ptr<Framebuffer>> framebuffers(nb_frames);
+    std::vector<RenderStats> frame_stats(nb_frames);
+    std::vector<TaskGraph::TaskId> render_tasks(nb_frames);
+    std::vector<TaskGraph::TaskId> encode_tasks(nb_frames);
+    for (u32 frame = 0u; frame < nb_frames; ++frame)
+    {
+        render_tasks[frame] = graph.add("render frame " + std::to_string(frame), [&, frame]()
+        {
+            if (!is_scene_ready)
+                return;
+
+            const Camera camera = get_frame_camera(settings, frame, nb_frames);
+
+            // Frames render in sequence, nothing traces the scene while it moves
+            if (animation && frame > 0u)
+            {
+                animation->set_time(f32(frame) / f32(nb_frames));
+                Hitable* tree = scene_build.world;
+                if (const OutlierBVH* outlier_bvh = dynamic_cast<const OutlierBVH*>(tree))
+                    tree = outlier_bvh->get_bvh();
+                if (DynamicBVH* dynamic_bvh = dynamic_cast<DynamicBVH*>(tree))
+                    dynamic_bvh->update().print();
+            }
+
+            framebuffers[frame] = is_numa ? std::make_unique<Framebuffer>(settings.width, settings.height, Framebuffer::Uninitialized {})
+                                          : std::make_unique<Framebuffer>(settings.width, settings.height);
+            BVHTraversalStats::reset();
+            frame_stats[frame] = renderer.render(camera, render_worlds, framebuffers[frame].get());
+            if (nb_frames > 1u)
+                util::output_to_console("Frame %u/%u", frame + 1u, nb_frames);
+            frame_stats[frame].print();
+            if (bvh_settings.build_stats && frame_stats[frame].nb_rays > 0u)
+                util::output_to_console("BVH: %.2f node visits per ray (%s traversal)",
+                                        f64(BVHTraversalStats::get_nb_node_visits()) / f64(frame_stats[frame].nb_rays), get_name(bvh_settings.traversal));
+        });
+        for (const TaskGraph::TaskId scene_task : scene_tasks)
+            graph.add_dependency(render_tasks[frame], scene_task);
+        if (frame > 0u)
+            graph.add_dependency(render_tasks[frame], render_tasks[frame - 1u]);
+        if (frame >= output_queue)
+            graph.add_dependency(render_tasks[frame], encode_tasks[frame - output_queue]);
+
+        std::stringstream filename;
+        filename << output_name;
+        if (nb_frames > 1u)
+            filename << "_f" << std::setw(4) << std::setfill('0') << frame;
 
-        const f32 pct = (f32(height - y) / height) * 100.f;
-        util::output_to_console("%.2f%% completed", pct);
+        encode_tasks[frame] = graph.add("encode frame " + std::to_string(frame), [&, frame, name = filename.str()]()
+        {
+            if (!framebuffers[frame])
+                return;
+            writer.write(name, *framebuffers[frame]);
+            framebuffers[frame].reset();
+            ImageWriter::write_metadata(name, get_metadata(settings, scene, frame_stats[frame]));
+        }, { render_tasks[frame] });
+
+        // Golden images cover the first frame, which is the still image when no animation is requested
+        if (frame == 0u && (args.has("--golden-write") || args.has("--golden-check")))
+        {
+            const TaskGraph::TaskId golden_task = graph.add("golden check", [&]()
+            {
+                if (framebuffers[0])
+                    exit_code = check_golden(args, *framebuffers[0], scene, settings);
+            }, { render_tasks[0] });
+            graph.add_dependency(encode_tasks[0], golden_task);
+        }
     }
 
-    util::output_img_to_incremental_file( width, height, data );
-    //util::output_img_to_file("test", width, height, data);
+    graph.run(stage_pool);
+    graph.print_report();
+    writer.get_stats().print();
 
-    util::safe_del(world);
+    for (Hitable*& world : worlds)
+        util::safe_del(world);
 
     PROFILER_BATCH_END_AND_LOG("test");
 
-    return 0;
-}
+    return exit_code;
+}
\ No newline at end of file